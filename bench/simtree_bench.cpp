@@ -0,0 +1,298 @@
+//
+//  simtree_bench.cpp
+//  simBAMM
+//
+//  Throughput benchmark: simulates a fixed suite of workloads from a
+//  fixed seed, without writing any files, and reports the timings as JSON.
+//
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "MbRandom.h"
+#include "SimArena.h"
+#include "SimTree.h"
+#include "SimTreeEngine.h"
+#include "SimulationConfig.h"
+#include "TreeWriter.h"
+
+
+typedef std::chrono::steady_clock Clock;
+
+
+struct Workload {
+    const char* name;
+    int numberOfTrees;
+    void (*configure)(SimulationConfig& config);
+};
+
+
+struct WorkloadResult {
+    long trees;
+    long attempts;
+    long nodes;
+    long steps;
+    double simulateSeconds;
+    double validateSeconds;
+    double serializeSeconds;
+    bool failed;
+};
+
+
+// Settings shared by every workload: those of example/control.txt
+
+SimulationConfig baseConfig()
+{
+    SimulationConfig config;
+    config.numberOfSims = 1;
+    config.eventRate = 0.01;
+    config.maxTime = 100.0;
+    config.maxTimeForEvent = 95.0;
+    config.inc = 0.1;
+    config.maxNumberOfNodes = 10000;
+    config.lambdaExpMean = 0.08;
+    config.muExpMean = 0.04;
+    config.rmin = 0.01;
+    config.rmax = 0.5;
+    config.rInitLogscale = true;
+    config.mintaxa = 100;
+    config.maxtaxa = 2000;
+    config.minNumberOfShifts = 1;
+    config.maxNumberOfShifts = 20;
+    return config;
+}
+
+
+const Workload Workloads[] = {
+    {"small", 2000, [](SimulationConfig& c){
+        c.maxTime = 50.0;
+        c.maxTimeForEvent = 50.0;
+        c.mintaxa = 5;
+        c.maxtaxa = 200;
+        c.minNumberOfShifts = 0;
+    }},
+    {"medium", 200, [](SimulationConfig&){
+    }},
+    {"huge", 5, [](SimulationConfig& c){
+        c.maxTime = 150.0;
+        c.maxTimeForEvent = 150.0;
+        c.maxNumberOfNodes = 100000;
+        c.mintaxa = 5000;
+        c.maxtaxa = 50000;
+        c.maxNumberOfShifts = 200;
+    }},
+    {"lowRejection", 500, [](SimulationConfig& c){
+        c.mintaxa = 1;
+        c.maxtaxa = 10000;
+        c.minNumberOfShifts = 0;
+        c.maxNumberOfShifts = 1000;
+        c.maxNumberOfNodes = 50000;
+    }},
+    {"highRejection", 20, [](SimulationConfig& c){
+        c.mintaxa = 400;
+        c.maxtaxa = 450;
+    }},
+    {"highShift", 100, [](SimulationConfig& c){
+        c.eventRate = 0.1;
+        c.minNumberOfShifts = 10;
+        c.maxNumberOfShifts = 500;
+    }}
+};
+
+const int NumberOfWorkloads = (int)(sizeof(Workloads) / sizeof(Workloads[0]));
+
+// Attempts per tree before a workload is reported as failed, as in SimTreeEngine
+const int MaxAttempts = 2000;
+
+
+double secondsSince(Clock::time_point start)
+{
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+
+WorkloadResult runWorkload(const SimulationConfig& config, int numberOfTrees, long int seed)
+{
+    WorkloadResult result = {0, 0, 0, 0, 0.0, 0.0, 0.0, false};
+    
+    MbRandom master(config.rngEngine, seed);
+    if (config.rngEngine == LcgEngine){
+        for (int i = 0; i < 5000; i++){
+            master.uniformRv();
+        }
+    }
+    
+    SimArena arena;
+    TreeWriter writer;
+    
+    for (int i = 0; i < numberOfTrees && !result.failed; i++){
+        MbRandom random = master.getStream(i);
+        
+        bool isAccepted = false;
+        for (int attempt = 0; !isAccepted; attempt++){
+            if (attempt > MaxAttempts){
+                result.failed = true;
+                break;
+            }
+            
+            Clock::time_point start = Clock::now();
+            SimTree* tree = new SimTree(&random, &config, &arena);
+            result.simulateSeconds += secondsSince(start);
+            
+            start = Clock::now();
+            isAccepted = SimTreeEngine::isTreeValid(tree, &config);
+            result.validateSeconds += secondsSince(start);
+            
+            result.attempts++;
+            result.nodes += tree->getTreeStore()->size();
+            result.steps += tree->getNumberOfSteps();
+            
+            if (isAccepted){
+                start = Clock::now();
+                tree->getTreeStore()->computeSpanningTips();
+                writer.clear();
+                writer.writeNewick(tree);
+                writer.writeEventData(i + 1, tree);
+                result.serializeSeconds += secondsSince(start);
+                result.trees++;
+            }
+            
+            delete tree;
+            arena.reset();
+        }
+    }
+    
+    return result;
+}
+
+
+void writeResult(std::ostream& out, const char* name, const WorkloadResult& r)
+{
+    double seconds = r.simulateSeconds + r.validateSeconds + r.serializeSeconds;
+    
+    out << "    {\n";
+    out << "      \"name\": \"" << name << "\",\n";
+    out << "      \"failed\": " << (r.failed ? "true" : "false") << ",\n";
+    out << "      \"trees\": " << r.trees << ",\n";
+    out << "      \"attempts\": " << r.attempts << ",\n";
+    out << "      \"nodes\": " << r.nodes << ",\n";
+    out << "      \"steps\": " << r.steps << ",\n";
+    out << "      \"seconds\": " << seconds << ",\n";
+    out << "      \"treesPerSecond\": " << r.trees / seconds << ",\n";
+    out << "      \"attemptsPerSecond\": " << r.attempts / seconds << ",\n";
+    out << "      \"nodesPerSecond\": " << r.nodes / seconds << ",\n";
+    out << "      \"nsPerStep\": " << 1e9 * r.simulateSeconds / r.steps << ",\n";
+    out << "      \"phases\": {\n";
+    out << "        \"simulate\": " << r.simulateSeconds << ",\n";
+    out << "        \"validate\": " << r.validateSeconds << ",\n";
+    out << "        \"serialize\": " << r.serializeSeconds << "\n";
+    out << "      }\n";
+    out << "    }";
+}
+
+
+void exitWithUsage()
+{
+    std::cerr << "Usage: simtree_bench [--workload <name>] [--trees <n>] [--seed <s>]\n"
+                 "                     [--simulationEngine discrete|exact]\n"
+                 "                     [--rngEngine philox|lcg] [--out <file.json>]\n"
+                 "Workloads:";
+    for (int w = 0; w < NumberOfWorkloads; w++){
+        std::cerr << " " << Workloads[w].name;
+    }
+    std::cerr << std::endl;
+    std::exit(1);
+}
+
+
+int main(int argc, char* argv[])
+{
+    std::string only;
+    std::string outName;
+    int numberOfTrees = 0;
+    long int seed = 1;
+    
+    SimulationConfig base = baseConfig();
+    std::string engineName = "discrete";
+    std::string rngName = "philox";
+    
+    for (int i = 1; i < argc; i += 2){
+        std::string argName(argv[i]);
+        if (i + 1 == argc){
+            exitWithUsage();
+        }
+        std::string argValue(argv[i + 1]);
+        
+        if (argName == "--workload"){
+            only = argValue;
+        }else if (argName == "--trees"){
+            numberOfTrees = std::atoi(argValue.c_str());
+        }else if (argName == "--seed"){
+            seed = std::atol(argValue.c_str());
+        }else if (argName == "--simulationEngine" && (argValue == "discrete" || argValue == "exact")){
+            engineName = argValue;
+            base.simulationEngine = (argValue == "exact") ? ExactEngine : DiscreteEngine;
+        }else if (argName == "--rngEngine" && (argValue == "philox" || argValue == "lcg")){
+            rngName = argValue;
+            base.rngEngine = (argValue == "lcg") ? LcgEngine : PhiloxEngine;
+        }else if (argName == "--out"){
+            outName = argValue;
+        }else{
+            exitWithUsage();
+        }
+    }
+    
+    std::ofstream outFile;
+    if (!outName.empty()){
+        outFile.open(outName.c_str());
+        if (!outFile){
+            std::cerr << "Cannot write <<" << outName << ">>" << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& out = outName.empty() ? std::cout : outFile;
+    
+    out << "{\n";
+    out << "  \"benchmark\": \"simtree_bench\",\n";
+#ifdef __VERSION__
+    out << "  \"compiler\": \"" << __VERSION__ << "\",\n";
+#endif
+    out << "  \"simulationEngine\": \"" << engineName << "\",\n";
+    out << "  \"rngEngine\": \"" << rngName << "\",\n";
+    out << "  \"seed\": " << seed << ",\n";
+    out << "  \"workloads\": [\n";
+    
+    bool isFirst = true;
+    for (int w = 0; w < NumberOfWorkloads; w++){
+        const Workload& workload = Workloads[w];
+        if (!only.empty() && only != workload.name){
+            continue;
+        }
+        
+        SimulationConfig config = base;
+        workload.configure(config);
+        int n = numberOfTrees > 0 ? numberOfTrees : workload.numberOfTrees;
+        
+        std::cerr << "running " << workload.name << " (" << n << " trees)" << std::endl;
+        WorkloadResult result = runWorkload(config, n, seed);
+        
+        if (!isFirst){
+            out << ",\n";
+        }
+        writeResult(out, workload.name, result);
+        isFirst = false;
+    }
+    
+    out << "\n  ]\n}\n";
+    
+    if (isFirst){
+        std::cerr << "Unknown workload <<" << only << ">>" << std::endl;
+        return 1;
+    }
+    
+    return 0;
+}
@@ -7,11 +7,10 @@
 //
 
 #include "BranchEvent.h"
-#include "Node.h"
 
 
 BranchEvent::BranchEvent()
-  : _eventNode{nullptr},
+  : _eventNode{NoNode},
     _eventTime{0.0},
     _lambdaInit{0.0},
     _lambdaShift{0.0},
@@ -20,7 +19,7 @@ BranchEvent::BranchEvent()
 
 }
 
-BranchEvent::BranchEvent(Node* node, double time, double lambdaInit,
+BranchEvent::BranchEvent(NodeIndex node, double time, double lambdaInit,
                             double lambdaShift, double muInit)
   : _eventNode{node},
     _eventTime{time},
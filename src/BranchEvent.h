@@ -12,15 +12,15 @@
 #include <iostream>
 #include <set>
 
+#include "TreeStore.h"
 
-class Node;
 
 class BranchEvent
 {
     
 private:
     
-    Node*   _eventNode;
+    NodeIndex _eventNode;
     double  _eventTime;
     double  _lambdaInit;
     double  _lambdaShift;
@@ -29,10 +29,10 @@ private:
 public:
     
     BranchEvent();
-    BranchEvent(Node* node, double time, double lambdaInit, double lambdaShift, double muInit);
+    BranchEvent(NodeIndex node, double time, double lambdaInit, double lambdaShift, double muInit);
     
-    Node* getEventNode();
-    void setEventNode(Node* x);
+    NodeIndex getEventNode();
+    void setEventNode(NodeIndex x);
 
     double getEventTime();
     void setEventTime(double x);
@@ -49,12 +49,12 @@ public:
 
 };
 
-inline Node* BranchEvent::getEventNode()
+inline NodeIndex BranchEvent::getEventNode()
 {
     return _eventNode;
 }
 
-inline void BranchEvent::setEventNode(Node* x)
+inline void BranchEvent::setEventNode(NodeIndex x)
 {
     _eventNode = x;
 }
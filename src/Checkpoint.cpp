@@ -0,0 +1,250 @@
+//
+//  Checkpoint.cpp
+//  simBAMM
+//
+
+#include "Checkpoint.h"
+#include "SimulationConfig.h"
+#include "Log.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+
+namespace {
+
+void exitWithCheckpointError(const std::string& message)
+{
+    log(Error) << message << "\n";
+    std::exit(1);
+}
+
+
+std::string trim(const std::string& s)
+{
+    std::size_t first = s.find_first_not_of(" \t\r");
+    if (first == std::string::npos){
+        return "";
+    }
+    std::size_t last = s.find_last_not_of(" \t\r");
+    return s.substr(first, last - first + 1);
+}
+
+
+template <typename T>
+T getValue(const std::map<std::string, std::string>& values,
+           const std::string& name, const std::string& path)
+{
+    std::map<std::string, std::string>::const_iterator it = values.find(name);
+    T value = T();
+    if (it == values.end() || !(std::istringstream(it->second) >> value)){
+        exitWithCheckpointError("Checkpoint <<" + path + ">> has no valid <<" + name + ">>.");
+    }
+    return value;
+}
+
+
+template <>
+std::string getValue<std::string>(const std::map<std::string, std::string>& values,
+                                  const std::string& name, const std::string& path)
+{
+    std::map<std::string, std::string>::const_iterator it = values.find(name);
+    if (it == values.end()){
+        exitWithCheckpointError("Checkpoint <<" + path + ">> has no <<" + name + ">>.");
+    }
+    return it->second;
+}
+
+}
+
+
+Checkpoint::Checkpoint() :
+    seed{-1},
+    rngEngine{PhiloxEngine},
+    parameters{},
+    numberOfSims{0},
+    acceptedTrees{0},
+    isFinished{false},
+    treefile{},
+    eventfile{},
+    archivefile{},
+    fossiltreefile{},
+    fossileventfile{},
+    extanttreefile{},
+    extanteventfile{},
+    treefileBytes{0},
+    eventfileBytes{0},
+    archivefileBytes{0},
+    fossiltreefileBytes{0},
+    fossileventfileBytes{0},
+    extanttreefileBytes{0},
+    extanteventfileBytes{0}
+{
+}
+
+
+Checkpoint::Checkpoint(const SimulationConfig& config, long int seed) :
+    Checkpoint()
+{
+    this->seed = seed;
+    rngEngine = config.rngEngine;
+    parameters = digestParameters(config);
+    numberOfSims = config.numberOfSims;
+    treefile = config.treefile;
+    eventfile = config.eventfile;
+    archivefile = config.archivefile;
+    fossiltreefile = config.fossiltreefile;
+    fossileventfile = config.fossileventfile;
+    extanttreefile = config.extanttreefile;
+    extanteventfile = config.extanteventfile;
+}
+
+
+bool Checkpoint::read(const std::string& path)
+{
+    std::ifstream in(path.c_str());
+    if (!in){
+        return false;
+    }
+
+    std::map<std::string, std::string> values;
+    std::string line;
+    while (std::getline(in, line)){
+        if (line.empty() || line[0] == '#'){
+            continue;
+        }
+        std::size_t equals = line.find('=');
+        if (equals == std::string::npos){
+            exitWithCheckpointError("<<" + path + ">> is not a simtree checkpoint.");
+        }
+        values[trim(line.substr(0, equals))] = trim(line.substr(equals + 1));
+    }
+
+    seed = getValue<long int>(values, "seed", path);
+    rngEngine = getValue<std::string>(values, "rngEngine", path) == "lcg" ?
+        LcgEngine : PhiloxEngine;
+    parameters = getValue<std::string>(values, "parameters", path);
+    numberOfSims = getValue<int>(values, "numberOfSims", path);
+    acceptedTrees = getValue<int>(values, "acceptedTrees", path);
+    isFinished = getValue<int>(values, "finished", path) != 0;
+    treefile = getValue<std::string>(values, "treefile", path);
+    eventfile = getValue<std::string>(values, "eventfile", path);
+    archivefile = getValue<std::string>(values, "archivefile", path);
+    fossiltreefile = getValue<std::string>(values, "fossiltreefile", path);
+    fossileventfile = getValue<std::string>(values, "fossileventfile", path);
+    extanttreefile = getValue<std::string>(values, "extanttreefile", path);
+    extanteventfile = getValue<std::string>(values, "extanteventfile", path);
+    treefileBytes = getValue<uint64_t>(values, "treefileBytes", path);
+    eventfileBytes = getValue<uint64_t>(values, "eventfileBytes", path);
+    archivefileBytes = getValue<uint64_t>(values, "archivefileBytes", path);
+    fossiltreefileBytes = getValue<uint64_t>(values, "fossiltreefileBytes", path);
+    fossileventfileBytes = getValue<uint64_t>(values, "fossileventfileBytes", path);
+    extanttreefileBytes = getValue<uint64_t>(values, "extanttreefileBytes", path);
+    extanteventfileBytes = getValue<uint64_t>(values, "extanteventfileBytes", path);
+    return true;
+}
+
+
+// Written to a temporary file and renamed, so that a crash while writing
+//   leaves the previous checkpoint in place
+
+void Checkpoint::write(const std::string& path) const
+{
+    std::string temporary = path + ".tmp";
+    std::ofstream out(temporary.c_str());
+
+    out << "# simtree checkpoint\n";
+    out << "seed = " << seed << "\n";
+    out << "rngEngine = " << (rngEngine == LcgEngine ? "lcg" : "philox") << "\n";
+    out << "parameters = " << parameters << "\n";
+    out << "numberOfSims = " << numberOfSims << "\n";
+    out << "acceptedTrees = " << acceptedTrees << "\n";
+    out << "finished = " << (isFinished ? 1 : 0) << "\n";
+    out << "treefile = " << treefile << "\n";
+    out << "eventfile = " << eventfile << "\n";
+    out << "archivefile = " << archivefile << "\n";
+    out << "fossiltreefile = " << fossiltreefile << "\n";
+    out << "fossileventfile = " << fossileventfile << "\n";
+    out << "extanttreefile = " << extanttreefile << "\n";
+    out << "extanteventfile = " << extanteventfile << "\n";
+    out << "treefileBytes = " << treefileBytes << "\n";
+    out << "eventfileBytes = " << eventfileBytes << "\n";
+    out << "archivefileBytes = " << archivefileBytes << "\n";
+    out << "fossiltreefileBytes = " << fossiltreefileBytes << "\n";
+    out << "fossileventfileBytes = " << fossileventfileBytes << "\n";
+    out << "extanttreefileBytes = " << extanttreefileBytes << "\n";
+    out << "extanteventfileBytes = " << extanteventfileBytes << "\n";
+
+    out.close();
+    if (!out){
+        exitWithCheckpointError("Cannot write checkpointfile <<" + path + ">>.");
+    }
+
+#ifdef _WIN32
+    std::remove(path.c_str());
+#endif
+    if (std::rename(temporary.c_str(), path.c_str()) != 0){
+        exitWithCheckpointError("Cannot write checkpointfile <<" + path + ">>.");
+    }
+}
+
+
+void Checkpoint::checkCanResume(const SimulationConfig& config) const
+{
+    if (config.seed != -1 && config.seed != seed){
+        exitWithCheckpointError("The checkpointed run used seed " + std::to_string(seed) + ".\n"
+                                "Fix by setting seed to -1 or to that seed.");
+    }
+    if (config.rngEngine != rngEngine || digestParameters(config) != parameters){
+        exitWithCheckpointError("The settings differ from those of the checkpointed run.\n"
+                                "Only numberOfSims, threads and the flush, checkpoint "
+                                "and metrics settings can change on resume.");
+    }
+    if (config.treefile != treefile || config.eventfile != eventfile ||
+            config.archivefile != archivefile || config.fossiltreefile != fossiltreefile ||
+            config.fossileventfile != fossileventfile ||
+            config.extanttreefile != extanttreefile || config.extanteventfile != extanteventfile){
+        exitWithCheckpointError("The output files differ from those of the checkpointed run.");
+    }
+    if (config.shardCount > 1 && config.numberOfSims != numberOfSims){
+        exitWithCheckpointError("The sims of a shard depend on numberOfSims, "
+                                "so a sharded run cannot be extended.");
+    }
+    if (config.numberOfSims < acceptedTrees){
+        exitWithCheckpointError("The checkpointed run has already written " +
+                                std::to_string(acceptedTrees) + " trees.\n"
+                                "Fix by setting numberOfSims to at least that number.");
+    }
+}
+
+
+// FNV-1a over the settings written out at full precision
+
+std::string Checkpoint::digestParameters(const SimulationConfig& config)
+{
+    std::ostringstream out;
+    out.precision(17);
+    out << config.simulationEngine << " " << config.eventRate << " " << config.maxTime
+        << " " << config.maxTimeForEvent << " " << config.inc << " " << config.maxNumberOfNodes
+        << " " << config.lambdaInit0 << " " << config.lambdaShift0 << " " << config.muInit0
+        << " " << config.lambdaExpMean << " " << config.muExpMean
+        << " " << config.rmin << " " << config.rmax << " " << config.epsmin << " " << config.epsmax
+        << " " << config.rInitLogscale << " " << config.mintaxa << " " << config.maxtaxa
+        << " " << config.minNumberOfShifts << " " << config.maxNumberOfShifts
+        << " " << config.minTime << " " << config.outputFormat << " " << config.outputPrecision
+        << " " << config.psi << " " << config.rho
+        << " " << config.shardIndex << "/" << config.shardCount;
+
+    std::string text = out.str();
+    uint64_t hash = 14695981039346656037ULL;
+    for (std::size_t i = 0; i < text.size(); i++){
+        hash = (hash ^ (unsigned char)text[i]) * 1099511628211ULL;
+    }
+
+    char digest[17];
+    std::snprintf(digest, sizeof(digest), "%016llx", (unsigned long long)hash);
+    return digest;
+}
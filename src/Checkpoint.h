@@ -0,0 +1,69 @@
+//
+//  Checkpoint.h
+//  simBAMM
+//
+
+#ifndef __simBAMM__Checkpoint__
+#define __simBAMM__Checkpoint__
+
+#include <cstdint>
+#include <string>
+
+#include "MbRandom.h"
+
+struct SimulationConfig;
+
+
+// The state a run needs to continue after it was stopped: how many trees
+//   were written and how long each output file was at that point.
+// Tree i always draws from stream i of the seed (see MbRandom::getStream),
+//   so the seed and the number of trees written are the whole random
+//   number state: trees that were being simulated when the run stopped
+//   are simply simulated again from the start of their streams.
+//
+// A checkpoint is a text file of "name = value" lines, replaced in one
+//   rename so that it always describes output that is on disk.
+
+struct Checkpoint
+{
+    long int seed;
+    RandomEngineType rngEngine;
+    std::string parameters;     // digest of the settings that shape the trees
+
+    int numberOfSims;
+    int acceptedTrees;          // the trees before this one are written
+    bool isFinished;
+
+    std::string treefile;
+    std::string eventfile;
+    std::string archivefile;
+    std::string fossiltreefile;
+    std::string fossileventfile;
+    std::string extanttreefile;
+    std::string extanteventfile;
+    uint64_t treefileBytes;
+    uint64_t eventfileBytes;
+    uint64_t archivefileBytes;  // end of the last tree record
+    uint64_t fossiltreefileBytes;
+    uint64_t fossileventfileBytes;
+    uint64_t extanttreefileBytes;
+    uint64_t extanteventfileBytes;
+
+    Checkpoint();
+
+    // Sets the fields that describe the run rather than its progress
+    Checkpoint(const SimulationConfig& config, long int seed);
+
+    // Returns false if the file does not exist; exits if it is not a checkpoint
+    bool read(const std::string& path);
+    void write(const std::string& path) const;
+
+    // Exits with an error message unless config continues this run
+    void checkCanResume(const SimulationConfig& config) const;
+
+    // Changes whenever a setting that shapes the trees or their text changes
+    static std::string digestParameters(const SimulationConfig& config);
+};
+
+
+#endif /* defined(__simBAMM__Checkpoint__) */
@@ -26,6 +26,13 @@ CommandLineProcessor::CommandLineProcessor(int argc, char* argv[])
             exitWithMessage(versionText());
         }
 
+        // --resume is a flag and takes no value
+        if (argName == "--resume") {
+            _parameters.push_back(UserParameter("resume", "1"));
+            i--;
+            continue;
+        }
+
         // Every argument name must be followed by its value
         if (i + 1 == argc) {
             exitWithError(missingArgumentValueText());
@@ -45,6 +52,9 @@ CommandLineProcessor::CommandLineProcessor(int argc, char* argv[])
             }
 
             argName = argName.substr(2);    // Cut out the "--"
+            if (argName == "only-sim") {
+                argName = "onlySim";
+            }
             _parameters.push_back(UserParameter(argName, argValue));
         }
     }
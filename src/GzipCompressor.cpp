@@ -0,0 +1,183 @@
+//
+//  GzipCompressor.cpp
+//  simBAMM
+//
+
+#include "GzipCompressor.h"
+#include "Log.h"
+
+#include <cstdlib>
+#include <utility>
+
+#ifdef SIMTREE_HAVE_ZLIB
+#include <zlib.h>
+
+struct GzipStream {
+    z_stream z;
+};
+
+const int NoFlushMode = Z_NO_FLUSH;
+const int SyncFlushMode = Z_SYNC_FLUSH;
+const int FinishMode = Z_FINISH;
+#else
+struct GzipStream {
+};
+
+const int NoFlushMode = 0;
+const int SyncFlushMode = 2;
+const int FinishMode = 4;
+#endif
+
+
+GzipCompressor::GzipCompressor(std::FILE* file, int level) :
+    _file{file},
+    _gzip{new GzipStream},
+    _out(1 << 18),
+    _mutex{},
+    _changed{},
+    _queue{},
+    _spareBuffers{},
+    _isBusy{false},
+    _isFinishing{false},
+    _maxQueuedBlocks{4},
+    _thread{}
+{
+#ifdef SIMTREE_HAVE_ZLIB
+    _gzip->z.zalloc = Z_NULL;
+    _gzip->z.zfree = Z_NULL;
+    _gzip->z.opaque = Z_NULL;
+    
+    // 15 + 16: largest window, with a gzip header and trailer
+    if (deflateInit2(&_gzip->z, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK){
+        log(Error) << "Cannot initialize gzip compression.\n";
+        std::exit(1);
+    }
+#else
+    (void)level;
+    log(Error) << "simtree was built without zlib; output cannot be compressed.\n";
+    std::exit(1);
+#endif
+    
+    _thread = std::thread(&GzipCompressor::run, this);
+}
+
+
+GzipCompressor::~GzipCompressor()
+{
+    finish();
+    delete _gzip;
+}
+
+
+bool GzipCompressor::isAvailable()
+{
+#ifdef SIMTREE_HAVE_ZLIB
+    return true;
+#else
+    return false;
+#endif
+}
+
+
+void GzipCompressor::write(const char* data, std::size_t n, bool isFlushPoint)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (_queue.size() >= _maxQueuedBlocks){
+        _changed.wait(lock);
+    }
+    
+    Block block;
+    if (!_spareBuffers.empty()){
+        block.data = std::move(_spareBuffers.back());
+        _spareBuffers.pop_back();
+    }
+    block.data.assign(data, data + n);
+    block.isFlushPoint = isFlushPoint;
+    
+    _queue.push_back(std::move(block));
+    _changed.notify_all();
+}
+
+
+void GzipCompressor::wait()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (!_queue.empty() || _isBusy){
+        _changed.wait(lock);
+    }
+}
+
+
+void GzipCompressor::finish()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_isFinishing){
+            return;
+        }
+        _isFinishing = true;
+        _changed.notify_all();
+    }
+    _thread.join();
+    
+#ifdef SIMTREE_HAVE_ZLIB
+    compress(nullptr, 0, FinishMode);
+    deflateEnd(&_gzip->z);
+#endif
+}
+
+
+// Background thread: compresses queued blocks in order until finish()
+
+void GzipCompressor::run()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    
+    while (true){
+        while (_queue.empty() && !_isFinishing){
+            _changed.wait(lock);
+        }
+        if (_queue.empty()){
+            break;
+        }
+        
+        Block block = std::move(_queue.front());
+        _queue.pop_front();
+        _isBusy = true;
+        lock.unlock();
+        
+        compress(block.data.data(), block.data.size(),
+                 block.isFlushPoint ? SyncFlushMode : NoFlushMode);
+        
+        lock.lock();
+        _spareBuffers.push_back(std::move(block.data));
+        _isBusy = false;
+        _changed.notify_all();
+    }
+}
+
+
+void GzipCompressor::compress(const char* data, std::size_t n, int mode)
+{
+#ifdef SIMTREE_HAVE_ZLIB
+    z_stream& z = _gzip->z;
+    z.next_in = (Bytef*)data;
+    z.avail_in = (uInt)n;
+    
+    do {
+        z.next_out = _out.data();
+        z.avail_out = (uInt)_out.size();
+        deflate(&z, mode);
+        
+        std::size_t have = _out.size() - z.avail_out;
+        if (have > 0 && std::fwrite(_out.data(), 1, have, _file) != have){
+            log(Error) << "Cannot write to output file.\n";
+            std::exit(1);
+        }
+    } while (z.avail_out == 0);
+#else
+    (void)data;
+    (void)n;
+    (void)mode;
+#endif
+}
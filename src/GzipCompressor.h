@@ -0,0 +1,75 @@
+//
+//  GzipCompressor.h
+//  simBAMM
+//
+
+#ifndef __simBAMM__GzipCompressor__
+#define __simBAMM__GzipCompressor__
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+struct GzipStream;
+
+
+// Compresses blocks of output into a gzip file on a background thread,
+//   so that the caller only pays for a memcpy per block.
+// The result is a single gzip member, readable by zcat or R's gzfile.
+// A block marked as a flush point is followed by a zlib sync flush, so
+//   that everything up to it can be decompressed from the file.
+
+class GzipCompressor
+{
+
+private:
+
+    struct Block {
+        std::vector<char> data;
+        bool isFlushPoint;
+    };
+
+    std::FILE* _file;
+    GzipStream* _gzip;
+    std::vector<unsigned char> _out;
+
+    std::mutex _mutex;
+    std::condition_variable _changed;
+    std::deque<Block> _queue;
+    std::vector<std::vector<char>> _spareBuffers;
+    bool _isBusy;
+    bool _isFinishing;
+    std::size_t _maxQueuedBlocks;
+
+    std::thread _thread;
+
+    void run();
+    void compress(const char* data, std::size_t n, int mode);
+
+public:
+
+    GzipCompressor(std::FILE* file, int level = 6);
+    GzipCompressor(const GzipCompressor&) = delete;
+    GzipCompressor& operator=(const GzipCompressor&) = delete;
+    ~GzipCompressor();
+
+    // Queues a copy of the data; blocks only when the queue is full
+    void write(const char* data, std::size_t n, bool isFlushPoint);
+
+    // Returns once every queued block has been written to the file
+    void wait();
+
+    // Compresses what is left, writes the gzip trailer and stops the thread
+    void finish();
+
+    // False when simtree was built without zlib
+    static bool isAvailable();
+};
+
+
+#endif /* defined(__simBAMM__GzipCompressor__) */
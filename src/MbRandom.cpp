@@ -31,6 +31,7 @@
  * $Id: MbRandom.cpp,v 1.3 2006/09/11 17:29:51 paulvdm Exp $
  */
 
+#include <algorithm>
 #include <cmath>
 #include <ctime>
 #include <cstdlib>
@@ -39,6 +40,242 @@
 
 #include "MbRandom.h"
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#    define MBRANDOM_X86_SIMD
+#    include <immintrin.h>
+#endif
+
+namespace {
+
+/*!
+ * The vector instruction sets that the batched generators can use, best first.
+ * Every level gives exactly the same random numbers.
+ */
+enum SimdLevel {
+    Avx512Simd,
+    Avx2Simd,
+    ScalarSimd
+};
+
+SimdLevel detectSimdLevel(void) {
+#ifdef MBRANDOM_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return Avx512Simd;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return Avx2Simd;
+    }
+#endif
+    return ScalarSimd;
+}
+
+SimdLevel getSimdLevel(void) {
+    static const SimdLevel level = detectSimdLevel();
+    return level;
+}
+
+const uint64_t LcgModulus = 2147483647;
+
+/*!
+ * 16807^k modulo 2^31 - 1: the multiplier that advances the Park-Miller
+ * generator by k steps.
+ */
+uint64_t lcgJump(int k) {
+    uint64_t a = 1;
+    for (int i = 0; i < k; i++) {
+        a = (a * 16807) % LcgModulus;
+    }
+    return a;
+}
+
+/*!
+ * The uniform(0,1) variable made from 64 random bits, centered on the 2^-53 grid
+ * so that 0 and 1 are never returned.
+ */
+inline double philoxUniform(uint32_t hi, uint32_t lo) {
+    uint64_t x = ((uint64_t)hi << 32) | lo;
+    return ((double)(x >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+}
+
+/*!
+ * The ten rounds of Philox4x32 on counter c with key (k0, k1).
+ */
+inline void philoxRounds(uint32_t c[4], uint32_t k0, uint32_t k1) {
+    for (int round = 0; round < 10; round++) {
+        uint64_t p0 = (uint64_t)0xD2511F53 * c[0];
+        uint64_t p1 = (uint64_t)0xCD9E8D57 * c[2];
+        uint32_t n0 = (uint32_t)(p1 >> 32) ^ c[1] ^ k0;
+        uint32_t n2 = (uint32_t)(p0 >> 32) ^ c[3] ^ k1;
+        c[0] = n0;
+        c[1] = (uint32_t)p1;
+        c[2] = n2;
+        c[3] = (uint32_t)p0;
+        k0 += 0x9E3779B9;
+        k1 += 0xBB67AE85;
+    }
+}
+
+void philoxBlocksScalar(uint64_t ctr, int blocks, uint64_t stream, uint64_t key, double* x) {
+    for (int b = 0; b < blocks; b++) {
+        uint32_t c[4] = {(uint32_t)(ctr + b), (uint32_t)((ctr + b) >> 32),
+                         (uint32_t)stream, (uint32_t)(stream >> 32)};
+        philoxRounds(c, (uint32_t)key, (uint32_t)(key >> 32));
+        x[2 * b] = philoxUniform(c[0], c[1]);
+        x[2 * b + 1] = philoxUniform(c[2], c[3]);
+    }
+}
+
+#ifdef MBRANDOM_X86_SIMD
+
+/*!
+ * Philox4x32-10 on 4 (AVX2) or 8 (AVX-512) counters at once. Each 32-bit word is
+ * kept in a 64-bit lane, so that one unsigned 32x32 multiplication gives both
+ * halves of its product.
+ */
+__attribute__((target("avx2")))
+void philoxBlocksAvx2(uint64_t ctr, int blocks, uint64_t stream, uint64_t key, double* x) {
+    const __m256i mask = _mm256_set1_epi64x(0xFFFFFFFF);
+    const __m256i m0 = _mm256_set1_epi64x(0xD2511F53);
+    const __m256i m1 = _mm256_set1_epi64x(0xCD9E8D57);
+    alignas(32) uint64_t hi[4];
+    alignas(32) uint64_t lo[4];
+    int b = 0;
+    for (; b + 4 <= blocks; b += 4) {
+        uint64_t c = ctr + b;
+        __m256i counters = _mm256_set_epi64x(c + 3, c + 2, c + 1, c);
+        __m256i c0 = _mm256_and_si256(counters, mask);
+        __m256i c1 = _mm256_srli_epi64(counters, 32);
+        __m256i c2 = _mm256_set1_epi64x(stream & 0xFFFFFFFF);
+        __m256i c3 = _mm256_set1_epi64x(stream >> 32);
+        uint32_t k0 = (uint32_t)key;
+        uint32_t k1 = (uint32_t)(key >> 32);
+        for (int round = 0; round < 10; round++) {
+            __m256i p0 = _mm256_mul_epu32(m0, c0);
+            __m256i p1 = _mm256_mul_epu32(m1, c2);
+            __m256i n0 = _mm256_xor_si256(_mm256_xor_si256(_mm256_srli_epi64(p1, 32), c1),
+                                          _mm256_set1_epi64x(k0));
+            __m256i n2 = _mm256_xor_si256(_mm256_xor_si256(_mm256_srli_epi64(p0, 32), c3),
+                                          _mm256_set1_epi64x(k1));
+            c0 = n0;
+            c1 = _mm256_and_si256(p1, mask);
+            c2 = n2;
+            c3 = _mm256_and_si256(p0, mask);
+            k0 += 0x9E3779B9;
+            k1 += 0xBB67AE85;
+        }
+        _mm256_store_si256((__m256i*)hi, _mm256_or_si256(_mm256_slli_epi64(c0, 32), c1));
+        _mm256_store_si256((__m256i*)lo, _mm256_or_si256(_mm256_slli_epi64(c2, 32), c3));
+        for (int j = 0; j < 4; j++) {
+            x[2 * (b + j)] = ((double)(hi[j] >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+            x[2 * (b + j) + 1] = ((double)(lo[j] >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+        }
+    }
+    _mm256_zeroupper();
+    philoxBlocksScalar(ctr + b, blocks - b, stream, key, x + 2 * b);
+}
+
+// GCC 12 warns about the undefined pass-through operands of its own AVX-512 intrinsics
+#if !defined(__clang__)
+#    pragma GCC diagnostic push
+#    pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+__attribute__((target("avx512f")))
+void philoxBlocksAvx512(uint64_t ctr, int blocks, uint64_t stream, uint64_t key, double* x) {
+    const __m512i mask = _mm512_set1_epi64(0xFFFFFFFF);
+    const __m512i m0 = _mm512_set1_epi64(0xD2511F53);
+    const __m512i m1 = _mm512_set1_epi64(0xCD9E8D57);
+    const __m512i steps = _mm512_set_epi64(7, 6, 5, 4, 3, 2, 1, 0);
+    alignas(64) uint64_t hi[8];
+    alignas(64) uint64_t lo[8];
+    int b = 0;
+    for (; b + 8 <= blocks; b += 8) {
+        __m512i counters = _mm512_add_epi64(_mm512_set1_epi64(ctr + b), steps);
+        __m512i c0 = _mm512_and_si512(counters, mask);
+        __m512i c1 = _mm512_srli_epi64(counters, 32);
+        __m512i c2 = _mm512_set1_epi64(stream & 0xFFFFFFFF);
+        __m512i c3 = _mm512_set1_epi64(stream >> 32);
+        uint32_t k0 = (uint32_t)key;
+        uint32_t k1 = (uint32_t)(key >> 32);
+        for (int round = 0; round < 10; round++) {
+            __m512i p0 = _mm512_mul_epu32(m0, c0);
+            __m512i p1 = _mm512_mul_epu32(m1, c2);
+            __m512i n0 = _mm512_xor_si512(_mm512_xor_si512(_mm512_srli_epi64(p1, 32), c1),
+                                          _mm512_set1_epi64(k0));
+            __m512i n2 = _mm512_xor_si512(_mm512_xor_si512(_mm512_srli_epi64(p0, 32), c3),
+                                          _mm512_set1_epi64(k1));
+            c0 = n0;
+            c1 = _mm512_and_si512(p1, mask);
+            c2 = n2;
+            c3 = _mm512_and_si512(p0, mask);
+            k0 += 0x9E3779B9;
+            k1 += 0xBB67AE85;
+        }
+        _mm512_store_si512((void*)hi, _mm512_or_si512(_mm512_slli_epi64(c0, 32), c1));
+        _mm512_store_si512((void*)lo, _mm512_or_si512(_mm512_slli_epi64(c2, 32), c3));
+        for (int j = 0; j < 8; j++) {
+            x[2 * (b + j)] = ((double)(hi[j] >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+            x[2 * (b + j) + 1] = ((double)(lo[j] >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+        }
+    }
+    _mm256_zeroupper();
+    philoxBlocksScalar(ctr + b, blocks - b, stream, key, x + 2 * b);
+}
+
+/*!
+ * s[i] = a * s[i - lanes] modulo 2^31 - 1 for i >= lanes, where lanes is 4 (AVX2)
+ * or 8 (AVX-512) and a = 16807^lanes. The products fit in 62 bits; folding the
+ * bits above 31 back in once is enough, because no state is a multiple of the
+ * modulus.
+ */
+__attribute__((target("avx2")))
+void lcgAvx2(uint64_t* s, int n, uint64_t a) {
+    const int lanes = 4;
+    const __m256i multiplier = _mm256_set1_epi64x(a);
+    const __m256i modulus = _mm256_set1_epi64x(LcgModulus);
+    const __m256i belowModulus = _mm256_set1_epi64x(LcgModulus - 1);
+    int i = lanes;
+    for (; i + lanes <= n; i += lanes) {
+        __m256i p = _mm256_mul_epu32(multiplier, _mm256_loadu_si256((const __m256i*)(s + i - 4)));
+        __m256i r = _mm256_add_epi64(_mm256_and_si256(p, modulus), _mm256_srli_epi64(p, 31));
+        __m256i over = _mm256_cmpgt_epi64(r, belowModulus);
+        r = _mm256_sub_epi64(r, _mm256_and_si256(over, modulus));
+        _mm256_storeu_si256((__m256i*)(s + i), r);
+    }
+    _mm256_zeroupper();
+    for (; i < n; i++) {
+        s[i] = (a * s[i - lanes]) % LcgModulus;
+    }
+}
+
+__attribute__((target("avx512f")))
+void lcgAvx512(uint64_t* s, int n, uint64_t a) {
+    const int lanes = 8;
+    const __m512i multiplier = _mm512_set1_epi64(a);
+    const __m512i modulus = _mm512_set1_epi64(LcgModulus);
+    int i = lanes;
+    for (; i + lanes <= n; i += lanes) {
+        __m512i p = _mm512_mul_epu32(multiplier, _mm512_loadu_si512((const void*)(s + i - 8)));
+        __m512i r = _mm512_add_epi64(_mm512_and_si512(p, modulus), _mm512_srli_epi64(p, 31));
+        __mmask8 over = _mm512_cmpge_epu64_mask(r, modulus);
+        r = _mm512_mask_sub_epi64(r, over, r, modulus);
+        _mm512_storeu_si512((void*)(s + i), r);
+    }
+    _mm256_zeroupper();
+    for (; i < n; i++) {
+        s[i] = (a * s[i - lanes]) % LcgModulus;
+    }
+}
+
+#if !defined(__clang__)
+#    pragma GCC diagnostic pop
+#endif
+
+#endif
+
+}
+
 /*!
  * Constructor for MbRandom class. This constructor does not take
  * any parameters and initializes the seed using the current 
@@ -50,10 +287,16 @@
  * \throws Does not throw an error.
  */
 MbRandom::MbRandom(void)
-  : seed{0},
-    initializedFacTable{false},
+  : engine{LcgEngine},
+    seed{0},
+    stream{0},
+    counter{0},
+    philoxOut{0, 0, 0, 0},
+    philoxPos{2},
     availableNormalRv{false},
-    extraNormalRv{0.0}
+    extraNormalRv{0.0},
+    buffer{},
+    bufferPos{BufferSize}
 {
     setSeed();
 }
@@ -69,10 +312,47 @@ MbRandom::MbRandom(void)
  * \throws Does not throw an error.
  */
 MbRandom::MbRandom(long int x)
-  : seed{0},
-    initializedFacTable{false},
+  : engine{LcgEngine},
+    seed{0},
+    stream{0},
+    counter{0},
+    philoxOut{0, 0, 0, 0},
+    philoxPos{2},
     availableNormalRv{false},
-    extraNormalRv{0.0}
+    extraNormalRv{0.0},
+    buffer{},
+    bufferPos{BufferSize}
+{
+    if (x == -1) { // use clock
+        setSeed();
+    } else {
+        setSeed(x);
+    }
+}
+
+/*!
+ * Constructor for MbRandom class. This constructor selects the engine
+ * that generates the uniform random variables, and initializes its seed
+ * and, for the Philox engine, the stream.
+ *
+ * \brief Constructor for MbRandom, selecting the engine.
+ * \param e is the engine that generates the uniform random variables.
+ * \param x is a long integer with the user-supplied random number seed.
+ * \param s is the stream identifier (ignored by the LCG engine).
+ * \return Returns no value.
+ * \throws Does not throw an error.
+ */
+MbRandom::MbRandom(RandomEngineType e, long int x, uint64_t s)
+  : engine{e},
+    seed{0},
+    stream{s},
+    counter{0},
+    philoxOut{0, 0, 0, 0},
+    philoxPos{2},
+    availableNormalRv{false},
+    extraNormalRv{0.0},
+    buffer{},
+    bufferPos{BufferSize}
 {
     if (x == -1) { // use clock
         setSeed();
@@ -388,22 +668,75 @@ double MbRandom::normalQuantile(double mu, double sigma, double p) {
 }
 
 /*!
- * This function generates a uniformly-distributed random variable on the interval [0,1).
- * It is a version of the Marsaglia Multi-Carry.
+ * This function fills x with n uniform(0,1) random variables: those that n calls
+ * of uniformRv would return, in the same order. The variables still in the buffer
+ * come first; the rest are generated straight into x.
+ *
+ * \brief Block of uniform(0,1) random variables.
+ * \param x is the array to fill.
+ * \param n is the number of random variables.
+ * \return This function does not return anything.
+ * \throws Does not throw an error.
+ */
+void MbRandom::fillUniform(double* x, int n) {
+    int k = 0;
+    while (k < n && bufferPos < BufferSize) {
+        x[k++] = buffer[bufferPos++];
+    }
+    if (k == n) {
+        return;
+    }
+    if (engine == PhiloxEngine) {
+        philoxFill(x + k, n - k);
+    } else {
+        lcgFill(x + k, n - k);
+    }
+}
+
+/*!
+ * This function fills x with n exponentially-distributed random variables: those
+ * that n calls of exponentialRv would return, in the same order.
  *
- * Taken from:
- *   Mathlib : A C Library of Special Functions
- *   Copyright (C) 2000, 2003  The R Development Core Team
+ * \brief Block of exponential random variables.
+ * \param x is the array to fill.
+ * \param n is the number of random variables.
+ * \param lambda is the rate parameter of the exponential.
+ * \return This function does not return anything.
+ * \throws Does not throw an error.
+ */
+void MbRandom::fillExponential(double* x, int n, double lambda) {
+    fillUniform(x, n);
+    for (int k = 0; k < n; k++) {
+        x[k] = -(1.0 / lambda) * std::log( x[k] );
+    }
+}
+
+/*!
+ * This function generates the next BufferSize uniform random variables of the
+ * engine into the buffer.
  *
- * This random generator has a period of 2^60, which ensures it has the maximum
- * period of 2^32 for unsigned ints (32 bit ints).
+ * \brief Refill the buffer of uniform random variables.
+ * \return This function does not return anything.
+ * \throws Does not throw an error.
+ */
+void MbRandom::refillBuffer(void) {
+    if (engine == PhiloxEngine) {
+        philoxFill(buffer, BufferSize);
+    } else {
+        lcgFill(buffer, BufferSize);
+    }
+    bufferPos = 0;
+}
+
+/*!
+ * This function generates a uniformly-distributed random variable on the interval (0,1)
+ * with the minimal standard generator of Park and Miller (1988), using Schrage's method.
  *
- * \brief Uniform[0,1) random variable.
- * \return Returns a uniformly-distributed random variable on the interval [0,1).
+ * \brief Uniform(0,1) random variable from the LCG engine.
+ * \return Returns a uniformly-distributed random variable on the interval (0,1).
  * \throws Does not throw an error.
- * \see http://stat.fsu.edu/~geo/diehard.html
  */
-double MbRandom::uniformRv(void) {
+double MbRandom::lcgUniformRv(void) {
     long int hi = seed / 127773;
     long int lo = seed % 127773;
     long int test = 16807 * lo - 2836 * hi;
@@ -415,6 +748,122 @@ double MbRandom::uniformRv(void) {
     return (double)(seed) / (double)2147483647;
 }
 
+/*!
+ * This function fills x with the next n uniform(0,1) random variables of the
+ * Park-Miller generator. The generator is advanced in as many lanes as the
+ * vector unit holds, lane i jumping from state i to state i + lanes with the
+ * multiplier 16807^lanes; the states and the variables are exactly those of
+ * lcgUniformRv.
+ *
+ * \brief Uniform(0,1) random variables from the LCG engine.
+ * \param x is the array to fill.
+ * \param n is the number of random variables.
+ * \return This function does not return anything.
+ * \throws Does not throw an error.
+ */
+void MbRandom::lcgFill(double* x, int n) {
+    int k = 0;
+#ifdef MBRANDOM_X86_SIMD
+    SimdLevel level = getSimdLevel();
+    if (level != ScalarSimd) {
+        int lanes = (level == Avx512Simd) ? 8 : 4;
+        static const uint64_t jump4 = lcgJump(4);
+        static const uint64_t jump8 = lcgJump(8);
+
+        uint64_t s[BufferSize];
+        while (n - k > lanes) {
+            int m = std::min(n - k, (int)BufferSize);
+            bool isValid = true;
+            for (int i = 0; i < lanes; i++) {
+                x[k + i] = lcgUniformRv();
+                s[i] = (uint64_t)seed;
+                isValid = isValid && s[i] < LcgModulus;
+            }
+            // A seed outside the range of the generator is left to lcgUniformRv
+            if (!isValid) {
+                k += lanes;
+                break;
+            }
+            if (level == Avx512Simd) {
+                lcgAvx512(s, m, jump8);
+            } else {
+                lcgAvx2(s, m, jump4);
+            }
+            for (int i = lanes; i < m; i++) {
+                x[k + i] = (double)(long int)s[i] / (double)2147483647;
+            }
+            seed = (long int)s[m - 1];
+            k += m;
+        }
+    }
+#endif
+    for (; k < n; k++) {
+        x[k] = lcgUniformRv();
+    }
+}
+
+/*!
+ * This function fills x with the next n uniform(0,1) random variables of the
+ * Philox4x32-10 engine. Each block of the generator gives 128 random bits, which
+ * are used for two variables with 53 bits of precision each; whole blocks are
+ * computed several at a time with AVX2 or AVX-512 when the processor has them.
+ *
+ * \brief Uniform(0,1) random variables from the Philox engine.
+ * \param x is the array to fill.
+ * \param n is the number of random variables.
+ * \return This function does not return anything.
+ * \throws Does not throw an error.
+ */
+void MbRandom::philoxFill(double* x, int n) {
+    int k = 0;
+    while (k < n && philoxPos < 2) {
+        x[k++] = philoxUniform(philoxOut[2 * philoxPos], philoxOut[2 * philoxPos + 1]);
+        philoxPos++;
+    }
+
+    int blocks = (n - k) / 2;
+    uint64_t key = (uint64_t)seed;
+#ifdef MBRANDOM_X86_SIMD
+    SimdLevel level = getSimdLevel();
+    if (level == Avx512Simd) {
+        philoxBlocksAvx512(counter, blocks, stream, key, x + k);
+    } else if (level == Avx2Simd) {
+        philoxBlocksAvx2(counter, blocks, stream, key, x + k);
+    } else {
+        philoxBlocksScalar(counter, blocks, stream, key, x + k);
+    }
+#else
+    philoxBlocksScalar(counter, blocks, stream, key, x + k);
+#endif
+    counter += blocks;
+    k += 2 * blocks;
+
+    if (k < n) {
+        philoxBlock(counter++);
+        x[k] = philoxUniform(philoxOut[0], philoxOut[1]);
+        philoxPos = 1;
+    }
+}
+
+/*!
+ * This function computes the Philox4x32-10 block for a given counter. The 128-bit
+ * counter holds the block index (low words) and the stream (high words); the
+ * 64-bit key is the seed.
+ *
+ * \brief Philox4x32-10 block function.
+ * \param ctr is the index of the block within the current stream.
+ * \return This function does not return anything.
+ * \throws Does not throw an error.
+ * \see Salmon JK, Moraes MA, Dror RO, Shaw DE (2011) Parallel random numbers: as easy as 1, 2, 3. SC11.
+ */
+void MbRandom::philoxBlock(uint64_t ctr) {
+    philoxOut[0] = (uint32_t)ctr;
+    philoxOut[1] = (uint32_t)(ctr >> 32);
+    philoxOut[2] = (uint32_t)stream;
+    philoxOut[3] = (uint32_t)(stream >> 32);
+    philoxRounds(philoxOut, (uint32_t)((uint64_t)seed), (uint32_t)((uint64_t)seed >> 32));
+}
+
 /*!
  * This function calculates the cumulative probability  
  * for a uniform(0,1) random variable.
@@ -1152,7 +1601,7 @@ double MbRandom::incompleteGamma (double x, double alpha, double LnGamma_alpha)
  * \throws Does not throw an error.
  */
 void MbRandom::setSeed(void) {
-    seed = (long int)( time( 0 ) );
+    setSeed((long int)( time( 0 ) ));
 }
 
 /*!
@@ -1168,6 +1617,10 @@ void MbRandom::setSeed(void) {
  */
 void MbRandom::setSeed(long int s) { 
     seed = s;
+    counter = 0;
+    philoxPos = 2;
+    bufferPos = BufferSize;
+    availableNormalRv = false;
 }
 
 /*!
@@ -1180,9 +1633,91 @@ void MbRandom::setSeed(long int s) {
  * \throws Does not throw an error.
  */
 long int MbRandom::getSeed(void) {
+    // The LCG state is that of the last variable handed out, which the buffer holds
+    if (engine == LcgEngine && bufferPos > 0 && bufferPos < BufferSize) {
+        return (long int)std::lround(buffer[bufferPos - 1] * 2147483647.0);
+    }
     return seed;
 }
 
+/*!
+ * This function returns the engine that generates the uniform random variables.
+ *
+ * \brief Return the engine type.
+ * \return Returns the engine type.
+ * \throws Does not throw an error.
+ */
+RandomEngineType MbRandom::getEngineType(void) {
+    return engine;
+}
+
+/*!
+ * This function returns a new generator for an independent stream. With the
+ * Philox engine the new generator shares the key (seed) and starts at the
+ * beginning of the given stream. The LCG engine has no streams; its new
+ * generator is seeded with a hash of the current state and the stream number,
+ * mapped onto the range of valid Park-Miller seeds.
+ *
+ * \brief Independent generator for a stream.
+ * \param s is the stream identifier.
+ * \return Returns the generator for the stream.
+ * \throws Does not throw an error.
+ */
+MbRandom MbRandom::getStream(uint64_t s) {
+    if (engine == PhiloxEngine) {
+        return MbRandom(PhiloxEngine, seed, s);
+    }
+
+    // splitmix64 finalizer
+    uint64_t z = (uint64_t)getSeed() + 0x9E3779B97F4A7C15ULL * (s + 1);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z = z ^ (z >> 31);
+
+    return MbRandom(LcgEngine, (long int)(z % 2147483646ULL) + 1);
+}
+
+/*!
+ * This function returns the number of uniform random variables drawn from the
+ * current stream. Only the Philox engine keeps a position; the state of the
+ * LCG engine is its seed.
+ *
+ * \brief Position in the current stream.
+ * \return Returns the number of uniform random variables drawn.
+ * \throws Does not throw an error.
+ */
+uint64_t MbRandom::getPosition(void) {
+    if (engine != PhiloxEngine) {
+        return 0;
+    }
+    // Less the variables generated into the buffer but not yet handed out
+    return 2 * counter + philoxPos - 2 - (BufferSize - bufferPos);
+}
+
+/*!
+ * This function moves the Philox engine to position n of its stream, in constant
+ * time, so that the next uniform random variable is the one that would follow
+ * n earlier draws. It has no effect on the LCG engine.
+ *
+ * \brief Jump to a position in the current stream.
+ * \param n is the number of uniform random variables to skip.
+ * \return This function does not return anything.
+ * \throws Does not throw an error.
+ */
+void MbRandom::setPosition(uint64_t n) {
+    if (engine != PhiloxEngine) {
+        return;
+    }
+    availableNormalRv = false;
+    bufferPos = BufferSize;
+    counter = n / 2;
+    philoxPos = 2;
+    if (n % 2 == 1) {
+        philoxBlock(counter++);
+        philoxPos = 1;
+    }
+}
+
 /*!
  * This function calculates the log of the gamma function, which is equal to:
  * Gamma(alp) = {integral from 0 to infinity} t^{alp-1} e^-t dt
@@ -1534,15 +2069,16 @@ double MbRandom::lnFactorial(int n) {
         if (n <= 1) {
             return 0.0;
         }
-        if ( initializedFacTable == false ) {
-            /* make table of ln(n!) */
-            double sum = facTable[0] = 0.0;
+        /* table of ln(n!), shared by all instances and built once (thread-safe) */
+        static const std::vector<double> facTable = [] {
+            std::vector<double> table(1024);
+            double sum = table[0] = 0.0;
             for (int i=1; i<1024; i++) {
                 sum += log((double)i);
-                facTable[i] = sum;
+                table[i] = sum;
             }
-            initializedFacTable = true;
-        }
+            return table;
+        }();
         return facTable[n];
     }
 
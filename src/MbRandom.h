@@ -39,11 +39,25 @@
 
 #include <cmath>
 #include <vector>
+#include <cstdint>
 
 #ifndef PI
 #    define PI 3.141592653589793
 #endif
 
+/*!
+ * The engines that can produce the uniform(0,1) stream underneath the
+ * distribution functions of MbRandom. LcgEngine is the original Park-Miller
+ * generator and reproduces the random numbers of earlier versions for a given
+ * seed. PhiloxEngine is the counter-based Philox4x32-10 generator of
+ * Salmon et al. (2011); its output is a pure function of (seed, stream, counter),
+ * so independent streams and jumps to any position take constant time.
+ */
+enum RandomEngineType {
+    LcgEngine,
+    PhiloxEngine
+};
+
 /*! 
  * MbRandom is a class that works with random variables. On creating an instance
  * of this class, a seed for a uniform random number is initialized. One can then
@@ -62,6 +76,11 @@ class MbRandom {
     public:
                              MbRandom(void);                                                                           /*!< constructor: initializes the seed with current time                            */
                              MbRandom(long int x);                                                                     /*!< constructor: initializes the seed with supplied value                          */
+                             MbRandom(RandomEngineType e, long int x, uint64_t stream = 0);                            /*!< constructor: selects the engine and initializes seed and stream                */
+          RandomEngineType   getEngineType(void);                                                                      /*!< retreives the engine that generates the uniform stream                         */
+                  MbRandom   getStream(uint64_t stream);                                                               /*!< independent generator for the given stream, in constant time                   */
+                  uint64_t   getPosition(void);                                                                        /*!< number of uniform variables drawn from the current stream (Philox)             */
+                      void   setPosition(uint64_t n);                                                                  /*!< jumps to position n of the current stream, in constant time (Philox)           */
                   long int   getSeed(void);                                                                            /*!< retreives the seeds                                                            */
                       void   setSeed(void);                                                                            /*!< initializes the seeds using the current time                                   */
                       void   setSeed(long int s);                                                                      /*!< initializes the seeds                                                          */
@@ -93,7 +112,9 @@ class MbRandom {
                     double   normalCdf(double mu, double sigma, double x);                                             /*!< Normal cumulative probability                                                  */
                     double   normalQuantile(double mu, double sigma, double p);                                        /*!< quantile of normal distribution                                                */
                     
-                    double   uniformRv(void);                                                       /* uniform(0,1) */ /*!< uniform(0,1) random variable                                                   */
+             inline double   uniformRv(void);                                                       /* uniform(0,1) */ /*!< uniform(0,1) random variable                                                   */
+                      void   fillUniform(double* x, int n);                                                            /*!< n uniform(0,1) random variables, as n calls of uniformRv would give             */
+                      void   fillExponential(double* x, int n, double lambda);                                         /*!< n exponential random variables, as n calls of exponentialRv would give          */
              inline double   uniformPdf(void);                                                                         /*!< Uniform(0,1) probability density                                               */
              inline double   lnUniformPdf(void);                                                                       /*!< natural log of Uniform(0,1) probability density                                */
                     double   uniformCdf(double x);                                                                     /*!< Uniform(0,1) cumulative probability                                            */
@@ -132,6 +153,11 @@ class MbRandom {
                     double   incompleteBeta(double a, double b, double x);                                             /*!< calculates the incomplete beta function                                        */
                     double   incompleteGamma (double x, double alpha, double LnGamma_alpha);                           /*!< calculates the incomplete gamma ratio                                          */
                     double   lnFactorial(int n);                                                                       /*!< log of factorial [ln(n!)]                                                      */
+                    double   lcgUniformRv(void);                                                                       /*!< uniform(0,1) from the Park-Miller generator                                    */
+                      void   lcgFill(double* x, int n);                                                                /*!< n uniform(0,1) from the Park-Miller generator, in vector batches                */
+                      void   philoxFill(double* x, int n);                                                             /*!< n uniform(0,1) from the Philox4x32-10 generator, in vector batches              */
+                      void   refillBuffer(void);                                                                       /*!< fills buffer with the next BufferSize uniform variables                         */
+                      void   philoxBlock(uint64_t ctr);                                                                /*!< fills philoxOut with the Philox4x32-10 block for counter ctr                   */
                     double   mbEpsilon(void);                                                                          /*!< round off unit for floating arithmetic                                         */
                     double   normalRv(void);                                                                           /*!< standard normal(0,1) random variable                                           */
                     double   pointNormal(double prob);                                                                 /*!< quantile of standard normal distribution                                       */
@@ -143,11 +169,17 @@ class MbRandom {
                     double   rndGamma2(double s);                                                                      /*!< function used when calculating gamma random variable                           */
                    
                             /* private data */
-                  long int   seed;                                                                                     /*!< seed values for the random number generator                                    */
-                      bool   initializedFacTable;                                                                      /*!< a boolean which is false if the log factorial table has not been initialized   */
-                    double   facTable[1024];                                                                           /*!< a table containing the log of the factorial up to 1024                         */
+          RandomEngineType   engine;                                                                                   /*!< the engine that generates the uniform stream                                   */
+                  long int   seed;                                                                                     /*!< seed values for the random number generator (the key for Philox)               */
+                  uint64_t   stream;                                                                                   /*!< stream identifier of the Philox generator                                      */
+                  uint64_t   counter;                                                                                  /*!< index of the next Philox block                                                 */
+                  uint32_t   philoxOut[4];                                                                             /*!< the current Philox block, two uniform variables                                */
+                       int   philoxPos;                                                                                /*!< number of uniform variables already used from philoxOut                        */
                       bool   availableNormalRv;                                                                        /*!< a boolean which is true if there is a normal random variable available         */
                     double   extraNormalRv;                                                                            /*!< a normally-distributed random variable which                                   */
+          static const int   BufferSize = 128;                                                                         /*!< number of uniform variables generated at a time                                 */
+                    double   buffer[BufferSize];                                                                       /*!< uniform variables generated ahead of their use                                  */
+                       int   bufferPos;                                                                                /*!< number of variables already used from buffer                                    */
 };
 
 
@@ -361,6 +393,23 @@ inline double MbRandom::lnNormalPdf(double mu, double var, double x) {
     return ( -0.5 * std::log( 2.0 * PI * var ) - (( x - mu ) * (x - mu) ) / (2 * var) );
 }
 
+/*!
+ * This function generates a uniformly-distributed random variable on the interval (0,1).
+ * The variables are generated BufferSize at a time, by whichever engine was selected,
+ * and handed out in order, so the stream is the same as if they were generated one
+ * by one.
+ *
+ * \brief Uniform(0,1) random variable.
+ * \return Returns a uniformly-distributed random variable on the interval (0,1).
+ * \throws Does not throw an error.
+ */
+inline double MbRandom::uniformRv(void) {
+    if (bufferPos == BufferSize) {
+        refillBuffer();
+    }
+    return buffer[bufferPos++];
+}
+
 /*!
  * This function calculates the probability density 
  * for a uniform(0,1) random variable.
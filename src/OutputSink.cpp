@@ -0,0 +1,249 @@
+//
+//  OutputSink.cpp
+//  simBAMM
+//
+
+#include "OutputSink.h"
+#include "GzipCompressor.h"
+#include "Log.h"
+
+#include <cstdlib>
+#include <cstring>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+namespace {
+
+// Cuts the file back to size bytes; false if it is shorter than that
+bool truncateFile(std::FILE* file, uint64_t size)
+{
+#ifdef _WIN32
+    int fd = _fileno(file);
+    if ((uint64_t)_filelengthi64(fd) < size){
+        return false;
+    }
+    return _chsize_s(fd, (__int64)size) == 0;
+#else
+    int fd = fileno(file);
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (uint64_t)info.st_size < size){
+        return false;
+    }
+    return ftruncate(fd, (off_t)size) == 0;
+#endif
+}
+
+}
+
+
+OutputSink::OutputSink(std::size_t bufferSize) :
+    std::streambuf(),
+    _file{nullptr},
+    _isStdout{false},
+    _compressor{nullptr},
+    _buffer(bufferSize),
+    _bytesFlushed{0},
+    _stream(this)
+{
+    setp(_buffer.data(), _buffer.data() + _buffer.size());
+}
+
+
+OutputSink::~OutputSink()
+{
+    close();
+}
+
+
+bool OutputSink::open(const std::string& path, OutputCompression compression)
+{
+    close();
+    
+    if (path == "-"){
+        _file = stdout;
+        _isStdout = true;
+    }else{
+        _file = std::fopen(path.c_str(), "wb");
+        _isStdout = false;
+    }
+    
+    if (_file == nullptr){
+        log(Error) << "Cannot open output file <<" << path << ">>.\n";
+        return false;
+    }
+    
+    // The sink does its own buffering
+    std::setvbuf(_file, nullptr, _IONBF, 0);
+    
+    if (compression == GzipCompression){
+        if (!GzipCompressor::isAvailable()){
+            log(Error) << "simtree was built without zlib; <<" << path
+                       << ">> cannot be compressed.\n";
+            close();
+            return false;
+        }
+        _compressor = new GzipCompressor(_file);
+    }
+    
+    _bytesFlushed = 0;
+    setp(_buffer.data(), _buffer.data() + _buffer.size());
+    return true;
+}
+
+
+bool OutputSink::resume(const std::string& path, uint64_t size)
+{
+    close();
+    
+    _file = std::fopen(path.c_str(), "r+b");
+    _isStdout = false;
+    if (_file == nullptr){
+        log(Error) << "Cannot reopen output file <<" << path << ">>.\n";
+        return false;
+    }
+    
+    std::setvbuf(_file, nullptr, _IONBF, 0);
+    
+    if (!truncateFile(_file, size) || std::fseek(_file, 0, SEEK_END) != 0){
+        log(Error) << "Output file <<" << path << ">> is shorter than at the checkpoint.\n";
+        close();
+        return false;
+    }
+    
+    _bytesFlushed = size;
+    setp(_buffer.data(), _buffer.data() + _buffer.size());
+    return true;
+}
+
+
+void OutputSink::write(const char* data, std::size_t n)
+{
+    if ((std::size_t)(epptr() - pptr()) < n){
+        drain(false);
+        if (n >= _buffer.size()){
+            emit(data, n, false);
+            return;
+        }
+    }
+    std::memcpy(pptr(), data, n);
+    pbump((int)n);
+}
+
+
+// Hands the buffered data to the operating system (or, when compressing,
+//   to the compressor, which sync-flushes after it)
+
+void OutputSink::flush()
+{
+    drain(true);
+}
+
+
+// Flushes and waits until the data is on disk
+
+void OutputSink::checkpoint()
+{
+    flush();
+    if (_compressor != nullptr){
+        _compressor->wait();
+    }
+    if (_file == nullptr || _isStdout){
+        return;
+    }
+#ifdef _WIN32
+    _commit(_fileno(_file));
+#else
+    fsync(fileno(_file));
+#endif
+}
+
+
+void OutputSink::close()
+{
+    if (_file == nullptr){
+        return;
+    }
+    if (_compressor != nullptr){
+        drain(false);
+        _compressor->finish();
+        delete _compressor;
+        _compressor = nullptr;
+    }
+    checkpoint();
+    if (!_isStdout){
+        std::fclose(_file);
+    }
+    _file = nullptr;
+}
+
+
+bool OutputSink::hasGzipExtension(const std::string& path)
+{
+    return path.size() > 3 && path.compare(path.size() - 3, 3, ".gz") == 0;
+}
+
+
+void OutputSink::drain(bool isFlushPoint)
+{
+    std::size_t n = pptr() - pbase();
+    if (n > 0 || (isFlushPoint && _compressor != nullptr)){
+        emit(pbase(), n, isFlushPoint);
+    }
+    setp(_buffer.data(), _buffer.data() + _buffer.size());
+}
+
+
+void OutputSink::emit(const char* data, std::size_t n, bool isFlushPoint)
+{
+    if (_file == nullptr){
+        return;
+    }
+    if (_compressor != nullptr){
+        _compressor->write(data, n, isFlushPoint);
+    }else{
+        writeToFile(data, n);
+    }
+    _bytesFlushed += n;
+}
+
+
+void OutputSink::writeToFile(const char* data, std::size_t n)
+{
+    if (std::fwrite(data, 1, n, _file) != n){
+        log(Error) << "Cannot write to output file.\n";
+        std::exit(1);
+    }
+}
+
+
+OutputSink::int_type OutputSink::overflow(int_type c)
+{
+    drain(false);
+    if (!traits_type::eq_int_type(c, traits_type::eof())){
+        *pptr() = traits_type::to_char_type(c);
+        pbump(1);
+    }
+    return traits_type::not_eof(c);
+}
+
+
+std::streamsize OutputSink::xsputn(const char* s, std::streamsize n)
+{
+    write(s, (std::size_t)n);
+    return n;
+}
+
+
+// std::flush on stream() only moves data to the sink's buffer;
+//   the sink decides when to write it out
+
+int OutputSink::sync()
+{
+    return 0;
+}
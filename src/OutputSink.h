@@ -0,0 +1,107 @@
+//
+//  OutputSink.h
+//  simBAMM
+//
+
+#ifndef __simBAMM__OutputSink__
+#define __simBAMM__OutputSink__
+
+#include <cstdio>
+#include <cstdint>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+class GzipCompressor;
+
+
+enum OutputCompression {
+    NoCompression,
+    GzipCompression
+};
+
+
+// An output file that stays open for the whole run, with a large
+//   user-space buffer. Data reaches the operating system only when the
+//   buffer is full or at an explicit flush(), and is made durable with
+//   fsync only at checkpoint(). A path of "-" writes to stdout.
+// With gzip compression the buffer is compressed on a background thread
+//   (see GzipCompressor) instead of being written directly.
+// stream() gives an std::ostream that writes into the same buffer.
+
+class OutputSink : public std::streambuf
+{
+
+private:
+
+    std::FILE* _file;
+    bool _isStdout;
+    GzipCompressor* _compressor;
+    std::vector<char> _buffer;
+    uint64_t _bytesFlushed;
+    std::ostream _stream;
+
+    void emit(const char* data, std::size_t n, bool isFlushPoint);
+    void drain(bool isFlushPoint);
+    void writeToFile(const char* data, std::size_t n);
+
+protected:
+
+    virtual int_type overflow(int_type c);
+    virtual std::streamsize xsputn(const char* s, std::streamsize n);
+    virtual int sync();
+
+public:
+
+    explicit OutputSink(std::size_t bufferSize = 1 << 20);
+    OutputSink(const OutputSink&) = delete;
+    OutputSink& operator=(const OutputSink&) = delete;
+    ~OutputSink();
+
+    bool open(const std::string& path, OutputCompression compression = NoCompression);
+    
+    // Reopens a file written by an earlier run, cut back to its first
+    //   size bytes, so that writing continues from a checkpoint
+    bool resume(const std::string& path, uint64_t size);
+    bool isOpen() const;
+
+    void write(const char* data, std::size_t n);
+    void write(const std::string& s);
+
+    void flush();
+    void checkpoint();
+    void close();
+
+    std::ostream& stream();
+
+    // Bytes written so far, including those still in the buffer
+    //   (before compression)
+    uint64_t getBytesWritten() const;
+
+    static bool hasGzipExtension(const std::string& path);
+};
+
+
+inline bool OutputSink::isOpen() const
+{
+    return _file != nullptr;
+}
+
+inline void OutputSink::write(const std::string& s)
+{
+    write(s.data(), s.size());
+}
+
+inline std::ostream& OutputSink::stream()
+{
+    return _stream;
+}
+
+inline uint64_t OutputSink::getBytesWritten() const
+{
+    return _bytesFlushed + (uint64_t)(pptr() - pbase());
+}
+
+
+#endif /* defined(__simBAMM__OutputSink__) */
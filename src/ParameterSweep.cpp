@@ -0,0 +1,212 @@
+//
+//  ParameterSweep.cpp
+//  simBAMM
+//
+
+#include "ParameterSweep.h"
+#include "Settings.h"
+#include "Log.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+
+namespace {
+
+std::vector<std::string> split(const std::string& s, char separator)
+{
+    std::vector<std::string> tokens;
+    std::istringstream in(s);
+    std::string token;
+    while (std::getline(in, token, separator)){
+        token.erase(std::remove_if(token.begin(), token.end(),
+            (int(*)(int))isspace), token.end());
+        tokens.push_back(token);
+    }
+    return tokens;
+}
+
+
+void exitWithSweepError(const std::string& message)
+{
+    log(Error) << message << "\n";
+    std::exit(1);
+}
+
+}
+
+
+ParameterSweep::ParameterSweep(const Settings& settings) :
+    _names{},
+    _values{},
+    _configs{}
+{
+    std::string table = settings.get("sweepTable");
+    std::string grid = settings.get("sweepGrid");
+    
+    if (table != "none" && grid != "none"){
+        exitWithSweepError("Set only one of sweepTable and sweepGrid.");
+    }
+    if (table != "none"){
+        readTable(table);
+    }else{
+        expandGrid(grid);
+    }
+    checkNames();
+    
+    // Each configuration is checked like a control file of its own
+    for (int i = 0; i < (int)_values.size(); i++){
+        Settings configSettings(settings);
+        for (int k = 0; k < (int)_names.size(); k++){
+            configSettings.set(_names[k], _values[i][k]);
+        }
+        _configs.push_back(SimulationConfig(configSettings));
+    }
+    
+    if (_configs[0].writesToStdout()){
+        exitWithSweepError("A sweep writes one file per configuration "
+                           "and cannot write to stdout.");
+    }
+    if (_configs[0].writesCheckpoints()){
+        exitWithSweepError("A sweep cannot be checkpointed.");
+    }
+    if (_configs[0].shardCount > 1 || _configs[0].onlySim != 0){
+        exitWithSweepError("A sweep cannot be sharded or replay a single sim.");
+    }
+}
+
+
+bool ParameterSweep::isRequested(const Settings& settings)
+{
+    return settings.get("sweepTable") != "none" || settings.get("sweepGrid") != "none";
+}
+
+
+void ParameterSweep::readTable(const std::string& path)
+{
+    std::ifstream in(path.c_str());
+    if (!in){
+        exitWithSweepError("Cannot read sweepTable <<" + path + ">>.");
+    }
+    
+    std::string line;
+    while (std::getline(in, line)){
+        std::vector<std::string> tokens = split(line, ',');
+        if (tokens.empty() || (tokens.size() == 1 && tokens[0].empty())){
+            continue;
+        }
+        if (_names.empty()){
+            _names = tokens;
+        }else if (tokens.size() != _names.size()){
+            exitWithSweepError("Row <<" + line + ">> of sweepTable does not "
+                               "have one value per column.");
+        }else{
+            _values.push_back(tokens);
+        }
+    }
+    
+    if (_values.empty()){
+        exitWithSweepError("sweepTable <<" + path + ">> has no configurations.");
+    }
+}
+
+
+void ParameterSweep::expandGrid(const std::string& grid)
+{
+    std::vector<std::vector<std::string>> levels;
+    std::vector<std::string> parameters = split(grid, ';');
+    for (int i = 0; i < (int)parameters.size(); i++){
+        std::vector<std::string> nameAndValues = split(parameters[i], ':');
+        if (nameAndValues.size() != 2 || nameAndValues[1].empty()){
+            exitWithSweepError("Cannot read <<" + parameters[i] + ">> in sweepGrid.\n"
+                               "Fix by writing it as name:value,value,...");
+        }
+        _names.push_back(nameAndValues[0]);
+        levels.push_back(split(nameAndValues[1], ','));
+    }
+    
+    // Odometer over the levels, last parameter fastest
+    std::vector<int> position(levels.size(), 0);
+    while (true){
+        std::vector<std::string> row;
+        for (int k = 0; k < (int)levels.size(); k++){
+            row.push_back(levels[k][position[k]]);
+        }
+        _values.push_back(row);
+        
+        int k = (int)levels.size() - 1;
+        while (k >= 0 && ++position[k] == (int)levels[k].size()){
+            position[k] = 0;
+            k--;
+        }
+        if (k < 0){
+            break;
+        }
+    }
+}
+
+
+// Settings of the run as a whole cannot differ between configurations
+
+void ParameterSweep::checkNames() const
+{
+    static const char* runSettings[] = {
+        "seed", "threads", "rngEngine", "treefile", "eventfile", "archivefile",
+        "fossiltreefile", "fossileventfile", "extanttreefile", "extanteventfile",
+        "outputFormat", "compression", "streamOutput", "outputFlushFreq",
+        "outputPrecision", "sweepTable", "sweepGrid", "sweepConfigFile",
+        "metricsfile", "metricsInterval", "checkpointfile", "checkpointFreq", "resume",
+        "shard", "onlySim", "printRejectedAttempts"
+    };
+    
+    for (int k = 0; k < (int)_names.size(); k++){
+        for (int i = 0; i < (int)(sizeof(runSettings) / sizeof(runSettings[0])); i++){
+            if (_names[k] == runSettings[i]){
+                exitWithSweepError("<<" + _names[k] + ">> applies to the whole run "
+                                   "and cannot be swept.");
+            }
+        }
+    }
+}
+
+
+void ParameterSweep::writeConfigTable(const std::string& path) const
+{
+    std::ofstream out(path.c_str());
+    if (!out){
+        exitWithSweepError("Cannot write sweepConfigFile <<" + path + ">>.");
+    }
+    
+    bool isArchive = _configs[0].outputFormat == ArchiveOutput;
+    out << (isArchive ? "config,archivefile" : "config,treefile,eventfile");
+    for (int k = 0; k < (int)_names.size(); k++){
+        out << "," << _names[k];
+    }
+    out << "\n";
+    
+    for (int i = 0; i < (int)_configs.size(); i++){
+        const SimulationConfig& c = _configs[i];
+        out << i + 1;
+        if (isArchive){
+            out << "," << configFileName(c.archivefile, i + 1);
+        }else{
+            out << "," << configFileName(c.treefile, i + 1);
+            out << "," << configFileName(c.eventfile, i + 1);
+        }
+        for (int k = 0; k < (int)_names.size(); k++){
+            out << "," << _values[i][k];
+        }
+        out << "\n";
+    }
+}
+
+
+// simtrees.txt -> simtrees_c3.txt, simtrees.txt.gz -> simtrees_c3.txt.gz
+
+std::string ParameterSweep::configFileName(const std::string& path, int configId)
+{
+    return taggedFileName(path, "_c" + std::to_string(configId));
+}
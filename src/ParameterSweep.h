@@ -0,0 +1,61 @@
+//
+//  ParameterSweep.h
+//  simBAMM
+//
+
+#ifndef __simBAMM__ParameterSweep__
+#define __simBAMM__ParameterSweep__
+
+#include <string>
+#include <vector>
+
+#include "SimulationConfig.h"
+
+class Settings;
+
+
+// Many configurations of the simulation run in one process.
+// The configurations are the control file settings with some parameters
+//   replaced, either by the rows of a CSV table (sweepTable: a header of
+//   parameter names, then one row of values per configuration) or by every
+//   combination of a grid (sweepGrid = "eventRate:0.01,0.05;epsmax:0.5,0.9",
+//   the last parameter varying fastest).
+// Configurations are numbered from 1; the output files of configuration c
+//   are the control file's names with "_c<c>" before the extension.
+
+class ParameterSweep
+{
+
+private:
+
+    std::vector<std::string> _names;
+    std::vector<std::vector<std::string>> _values;
+    std::vector<SimulationConfig> _configs;
+
+    void readTable(const std::string& path);
+    void expandGrid(const std::string& grid);
+    void checkNames() const;
+
+public:
+
+    explicit ParameterSweep(const Settings& settings);
+
+    // True if the settings ask for a sweep
+    static bool isRequested(const Settings& settings);
+
+    const std::vector<SimulationConfig>& getConfigs() const;
+
+    // Writes the table of configuration ids, output files and swept values
+    void writeConfigTable(const std::string& path) const;
+
+    static std::string configFileName(const std::string& path, int configId);
+};
+
+
+inline const std::vector<SimulationConfig>& ParameterSweep::getConfigs() const
+{
+    return _configs;
+}
+
+
+#endif /* defined(__simBAMM__ParameterSweep__) */
@@ -0,0 +1,191 @@
+//
+//  RunMetrics.cpp
+//  simBAMM
+//
+
+#include "RunMetrics.h"
+#include "Log.h"
+
+#include <cstdio>
+#include <fstream>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+
+RunMetrics::RunMetrics() :
+    _start{Clock::now()},
+    _acceptedTrees{0},
+    _maxAttemptsPerTree{0},
+    _path{"none"},
+    _interval{0.0},
+    _nextWrite{0},
+    _writeMutex{}
+{
+    for (int i = 0; i < NumberOfRejectionReasons; i++){
+        _attempts[i] = 0;
+        _nodes[i] = 0;
+        _nanoseconds[i] = 0;
+    }
+    for (int k = 0; k < NumberOfLatencyBuckets; k++){
+        _latencies[k] = 0;
+    }
+}
+
+
+void RunMetrics::setOutput(const std::string& path, double interval)
+{
+    _path = path;
+    _interval = interval;
+    _nextWrite = (int64_t)(interval * 1e9);
+}
+
+
+int64_t RunMetrics::getElapsedNanoseconds() const
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - _start).count();
+}
+
+
+void RunMetrics::addAttempt(RejectionReason reason, int nodes, int64_t nanoseconds)
+{
+    _attempts[reason]++;
+    _nodes[reason] += nodes;
+    _nanoseconds[reason] += nanoseconds;
+    
+    int k = 0;
+    for (int64_t us = nanoseconds / 1000; us > 0 && k < NumberOfLatencyBuckets - 1; us >>= 1){
+        k++;
+    }
+    _latencies[k]++;
+}
+
+
+void RunMetrics::addTree(long attempts)
+{
+    _acceptedTrees++;
+    
+    long max = _maxAttemptsPerTree;
+    while (attempts > max && !_maxAttemptsPerTree.compare_exchange_weak(max, attempts)){
+    }
+}
+
+
+// Only the thread that moves _nextWrite on writes the report
+
+void RunMetrics::writeIfDue()
+{
+    if (_interval <= 0.0 || _path == "none"){
+        return;
+    }
+    
+    int64_t now = getElapsedNanoseconds();
+    int64_t due = _nextWrite;
+    if (now < due){
+        return;
+    }
+    if (_nextWrite.compare_exchange_strong(due, now + (int64_t)(_interval * 1e9))){
+        write(false);
+    }
+}
+
+
+// The report is written to a temporary file and renamed, so that a
+//   reader never sees half of it
+
+void RunMetrics::write(bool isFinished)
+{
+    if (_path == "none"){
+        return;
+    }
+    
+    std::lock_guard<std::mutex> lock(_writeMutex);
+    
+    long attempts = 0;
+    long rejectedAttempts = 0;
+    long rejectedNodes = 0;
+    int64_t rejectedNanoseconds = 0;
+    for (int i = 0; i < NumberOfRejectionReasons; i++){
+        attempts += _attempts[i];
+        if (i != NotRejected){
+            rejectedAttempts += _attempts[i];
+            rejectedNodes += _nodes[i];
+            rejectedNanoseconds += _nanoseconds[i];
+        }
+    }
+    long trees = _acceptedTrees;
+    
+    std::string temporary = _path + ".tmp";
+    std::ofstream out(temporary.c_str());
+    if (!out){
+        log(Error) << "Cannot write metricsfile <<" << _path << ">>.\n";
+        return;
+    }
+    
+    out << "{\n";
+    out << "  \"finished\": " << (isFinished ? "true" : "false") << ",\n";
+    out << "  \"elapsedSeconds\": " << getElapsedNanoseconds() / 1e9 << ",\n";
+    out << "  \"acceptedTrees\": " << trees << ",\n";
+    out << "  \"attempts\": " << attempts << ",\n";
+    out << "  \"attemptsPerAcceptedTree\": " << (trees > 0 ? (double)attempts / trees : 0.0) << ",\n";
+    out << "  \"maxAttemptsPerTree\": " << _maxAttemptsPerTree << ",\n";
+    out << "  \"peakMemoryKiB\": " << getPeakMemory() << ",\n";
+    
+    out << "  \"rejections\": {";
+    for (int i = 1; i < NumberOfRejectionReasons; i++){
+        out << (i > 1 ? ", " : "") << "\"" << rejectionReasonName((RejectionReason)i)
+            << "\": " << _attempts[i];
+    }
+    out << "},\n";
+    
+    out << "  \"accepted\": {\"attempts\": " << _attempts[NotRejected]
+        << ", \"nodes\": " << _nodes[NotRejected]
+        << ", \"seconds\": " << _nanoseconds[NotRejected] / 1e9 << "},\n";
+    out << "  \"rejected\": {\"attempts\": " << rejectedAttempts
+        << ", \"nodes\": " << rejectedNodes
+        << ", \"seconds\": " << rejectedNanoseconds / 1e9 << "},\n";
+    
+    int last = NumberOfLatencyBuckets - 1;
+    while (last > 0 && _latencies[last] == 0){
+        last--;
+    }
+    out << "  \"attemptLatency\": [";
+    for (int k = 0; k <= last; k++){
+        out << (k > 0 ? ", " : "") << "{\"belowMicroseconds\": ";
+        if (k < NumberOfLatencyBuckets - 1){
+            out << (1L << k);
+        }else{
+            out << "null";
+        }
+        out << ", \"attempts\": " << _latencies[k] << "}";
+    }
+    out << "]\n";
+    out << "}\n";
+    out.close();
+    
+#ifdef _WIN32
+    std::remove(_path.c_str());
+#endif
+    if (std::rename(temporary.c_str(), _path.c_str()) != 0){
+        log(Error) << "Cannot write metricsfile <<" << _path << ">>.\n";
+    }
+}
+
+
+long RunMetrics::getPeakMemory()
+{
+#ifdef _WIN32
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0){
+        return 0;
+    }
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024;  // bytes on macOS
+#else
+    return usage.ru_maxrss;
+#endif
+#endif
+}
@@ -0,0 +1,87 @@
+//
+//  RunMetrics.h
+//  simBAMM
+//
+
+#ifndef __simBAMM__RunMetrics__
+#define __simBAMM__RunMetrics__
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+#include "SimTree.h"
+
+
+// Where the time of a run goes: every attempt, accepted or rejected, is
+//   counted with its number of nodes and its wall time. Updated by all
+//   the worker threads at once, so every counter is atomic.
+// write() produces a JSON report; it can be called while the run goes on.
+
+class RunMetrics
+{
+
+public:
+
+    // Attempt latencies are counted in power-of-two buckets of microseconds:
+    //   bucket k holds the attempts that took less than 2^k microseconds
+    //   (and at least 2^(k-1)); the last bucket holds all longer ones.
+    static const int NumberOfLatencyBuckets = 32;
+
+private:
+
+    typedef std::chrono::steady_clock Clock;
+
+    Clock::time_point _start;
+
+    std::atomic<long> _acceptedTrees;
+    std::atomic<long> _maxAttemptsPerTree;
+
+    std::atomic<long> _attempts[NumberOfRejectionReasons];
+    std::atomic<long> _nodes[NumberOfRejectionReasons];
+    std::atomic<int64_t> _nanoseconds[NumberOfRejectionReasons];
+
+    std::atomic<long> _latencies[NumberOfLatencyBuckets];
+
+    std::string _path;
+    double _interval;
+    std::atomic<int64_t> _nextWrite;    // nanoseconds since _start
+    std::mutex _writeMutex;
+
+    int64_t getElapsedNanoseconds() const;
+
+public:
+
+    RunMetrics();
+    RunMetrics(const RunMetrics&) = delete;
+    RunMetrics& operator=(const RunMetrics&) = delete;
+
+    // Reports go to path ("none": no report); with an interval > 0 they
+    //   are also rewritten every interval seconds by writeIfDue
+    void setOutput(const std::string& path, double interval);
+
+    // Records one attempt; reason is NotRejected for an accepted tree
+    void addAttempt(RejectionReason reason, int nodes, int64_t nanoseconds);
+
+    // Records an accepted tree and the number of attempts it took
+    void addTree(long attempts);
+
+    long getRejections(RejectionReason reason) const;
+
+    void writeIfDue();
+    void write(bool isFinished);
+
+    // Peak resident set size of the process, in KiB (0 if unknown)
+    static long getPeakMemory();
+};
+
+
+inline long RunMetrics::getRejections(RejectionReason reason) const
+{
+    return _attempts[reason];
+}
+
+
+#endif /* defined(__simBAMM__RunMetrics__) */
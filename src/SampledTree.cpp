@@ -0,0 +1,235 @@
+//
+//  SampledTree.cpp
+//  simBAMM
+//
+
+#include "SampledTree.h"
+#include "MbRandom.h"
+#include "SimTree.h"
+
+#include <cmath>
+
+
+SampledTree::SampledTree() :
+    _nodes{},
+    _source{},
+    _tipNumber{},
+    _events{},
+    _simulated{nullptr},
+    _records{},
+    _lastFossil{},
+    _sampledNode{},
+    _uniforms{},
+    _stack{}
+{
+}
+
+
+// The extant species are sampled before the fossils are drawn, so the
+//   same seed samples the same species whatever psi is
+
+void SampledTree::sampleFossils(const TreeStore* simulated, MbRandom* random,
+                                double psi, double rho)
+{
+    _simulated = simulated;
+    int n = simulated->size();
+    _records.assign(n, 0);
+    _lastFossil.assign(n, -1.0);
+    
+    for (NodeIndex x = 0; x < (NodeIndex)n; x++){
+        if (simulated->getIsTip(x) && simulated->getIsExtant(x) &&
+                (rho >= 1.0 || random->uniformRv() < rho)){
+            _records[x] = 1;
+            _lastFossil[x] = simulated->getTime(x);
+        }
+    }
+    
+    if (psi > 0.0){
+        for (NodeIndex x = 0; x < (NodeIndex)n; x++){
+            double brlen = simulated->getBrlen(x);
+            if (brlen <= 0.0){
+                continue;
+            }
+            int fossils = random->poissonRv(psi * brlen);
+            double start = simulated->getTime(x) - brlen;
+            _uniforms.resize(fossils);
+            random->fillUniform(_uniforms.data(), fossils);
+            for (int k = 0; k < fossils; k++){
+                double time = start + _uniforms[k] * brlen;
+                if (time > _lastFossil[x]){
+                    _lastFossil[x] = time;
+                }
+            }
+            _records[x] += (uint32_t)fossils;
+        }
+    }
+    
+    countRecordsBelow();
+    prune();
+}
+
+
+void SampledTree::keepExtant(const SampledTree& sampled)
+{
+    _simulated = sampled._simulated;
+    int n = _simulated->size();
+    _records.assign(n, 0);
+    _lastFossil.assign(n, -1.0);
+    
+    for (NodeIndex y = 0; y < (NodeIndex)sampled._nodes.size(); y++){
+        if (sampled._nodes.getIsTip(y) && sampled._nodes.getIsExtant(y)){
+            NodeIndex x = sampled._source[y];
+            _records[x] = 1;
+            _lastFossil[x] = _simulated->getTime(x);
+        }
+    }
+    
+    countRecordsBelow();
+    prune();
+}
+
+
+// Children come after their parent, so a backward pass is post-order
+
+void SampledTree::countRecordsBelow()
+{
+    for (int x = _simulated->size() - 1; x >= 0; x--){
+        NodeIndex lf = _simulated->getLfDesc(x);
+        if (lf != NoNode){
+            _records[x] += _records[lf] + _records[_simulated->getRtDesc(x)];
+        }
+    }
+}
+
+
+// Follows the only kept child of x until a node with two kept children,
+//   or none, is reached
+
+NodeIndex SampledTree::skipUnaryNodes(NodeIndex x) const
+{
+    while (true){
+        NodeIndex lf = _simulated->getLfDesc(x);
+        if (lf == NoNode){
+            return x;
+        }
+        NodeIndex rt = _simulated->getRtDesc(x);
+        bool isLeftKept = _records[lf] > 0;
+        if (isLeftKept == (_records[rt] > 0)){
+            return x;
+        }
+        x = isLeftKept ? lf : rt;
+    }
+}
+
+
+// Copies the kept nodes in preorder, left child first. A node ends at its
+//   last fossil if it becomes a tip; otherwise it keeps its time.
+
+void SampledTree::prune()
+{
+    _nodes.clear();
+    _source.clear();
+    _tipNumber.clear();
+    _events.clear();
+    _sampledNode.assign(_simulated->size(), NoNode);
+    
+    if (_simulated->size() == 0 || _records[0] == 0){
+        return;
+    }
+    
+    uint32_t fossilTips = 0;
+    _stack.clear();
+    _stack.push_back(std::make_pair(skipUnaryNodes(0), NoNode));
+    
+    while (!_stack.empty()){
+        NodeIndex x = _stack.back().first;
+        NodeIndex parent = _stack.back().second;
+        _stack.pop_back();
+        
+        NodeIndex lf = _simulated->getLfDesc(x);
+        NodeIndex rt = _simulated->getRtDesc(x);
+        bool isSimulatedTip = (lf == NoNode);
+        bool isTip = isSimulatedTip || (_records[lf] == 0 && _records[rt] == 0);
+        
+        double time = isTip ? _lastFossil[x] : _simulated->getTime(x);
+        NodeIndex y = _nodes.addNode(parent, time, _simulated->getRegime(x));
+        bool isExtant = isSimulatedTip && _simulated->getIsExtant(x) &&
+                        time == _simulated->getTime(x);
+        _nodes.setStatus(y, isTip, isExtant);
+        
+        _source.push_back(x);
+        _sampledNode[x] = y;
+        _tipNumber.push_back(isTip && !isSimulatedTip ? ++fossilTips : 0);
+        
+        if (parent != NoNode){
+            if (_nodes.getLfDesc(parent) == NoNode){
+                _nodes.setLfDesc(parent, y);
+            }else{
+                _nodes.setRtDesc(parent, y);
+            }
+        }
+        
+        if (!isTip){
+            _stack.push_back(std::make_pair(skipUnaryNodes(rt), y));
+            _stack.push_back(std::make_pair(skipUnaryNodes(lf), y));
+        }
+    }
+    
+    _nodes.computeSpanningTips();
+    
+    // A removed node lies on the branch of the node its kept child is on
+    for (int x = _simulated->size() - 1; x >= 0; x--){
+        if (_records[x] > 0 && _sampledNode[x] == NoNode){
+            NodeIndex lf = _simulated->getLfDesc(x);
+            NodeIndex rt = _simulated->getRtDesc(x);
+            _sampledNode[x] = _sampledNode[_records[lf] > 0 ? lf : rt];
+        }
+    }
+}
+
+
+// The root gets the regime in effect at its time, with the speciation rate
+//   it has reached by then. A shift is kept if its branch lies on a branch
+//   of this tree, after the root and before the lineage's last fossil.
+
+void SampledTree::remapEvents(SimTree* tree)
+{
+    _events.clear();
+    if (getRoot() == NoNode){
+        return;
+    }
+    
+    NodeIndex rootSource = _source[0];
+    double rootTime = _nodes.getTime(0);
+    
+    // A tip root ends at a fossil, so shifts after it on its branch do not count
+    NodeIndex parent = _simulated->getParent(rootSource);
+    BranchEvent* rootEvent = tree->getNodeEvent(parent != NoNode ? parent : rootSource);
+    for (int i = 0; i < tree->getNumberOfShifts(); i++){
+        BranchEvent* be = tree->getShiftEvent(i);
+        if (be->getEventNode() == rootSource && be->getEventTime() <= rootTime &&
+                be->getEventTime() > rootEvent->getEventTime()){
+            rootEvent = be;
+        }
+    }
+    
+    double elapsed = rootTime - rootEvent->getEventTime();
+    _events.push_back(BranchEvent(0, 0.0,
+        rootEvent->getLambdaInit() * std::exp(rootEvent->getLambdaShift() * elapsed),
+        rootEvent->getLambdaShift(), rootEvent->getMuInit()));
+    
+    for (int i = 0; i < tree->getNumberOfShifts(); i++){
+        BranchEvent* be = tree->getShiftEvent(i);
+        NodeIndex x = be->getEventNode();
+        double time = be->getEventTime();
+        if (_records[x] == 0 || time <= rootTime){
+            continue;
+        }
+        NodeIndex y = _sampledNode[x];
+        if (time > _nodes.getTime(y)){
+            continue;
+        }
+        _events.push_back(BranchEvent(y, time - rootTime, be->getLambdaInit(),
+                                      be->getLambdaShift(), be->getMuInit()));
+    }
+}
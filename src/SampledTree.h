@@ -0,0 +1,131 @@
+//
+//  SampledTree.h
+//  simBAMM
+//
+
+#ifndef __simBAMM__SampledTree__
+#define __simBAMM__SampledTree__
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "TreeStore.h"
+#include "BranchEvent.h"
+
+class MbRandom;
+class SimTree;
+
+
+// The tree that the fossil record and the sampled extant species of a
+//   simulated tree would show (simulateFossilSampling in R/degrade_tree.R).
+//
+// Fossils fall on every branch as a Poisson process of rate psi, and each
+//   extant tip is sampled with probability rho, which counts as a fossil at
+//   its end. A branch is kept if it or a branch below it has a fossil; a tip
+//   branch, or a branch none of whose descendants were kept, ends at its
+//   last fossil. Nodes left with one kept child are removed.
+//
+// Nodes are in preorder, left child first, with the absolute times of the
+//   simulated tree. Tips that were tips of the simulated tree keep its name
+//   (A# or D#, # being the simulated node); lineages that end at a fossil of
+//   an internal branch become the tips NN1, NN2, ... in Newick order.
+//
+// keepExtant gives the reconstructed tree of the extant species that another
+//   sample holds: with psi = 0 that is the sample itself.
+//
+// remapEvents carries the shifts of the simulated tree over to this tree
+//   (convertEventData in R/degrade_tree.R), with times from its root.
+
+class SampledTree
+{
+
+private:
+
+    TreeStore _nodes;
+    std::vector<NodeIndex> _source;     // simulated node each node ends in
+    std::vector<uint32_t> _tipNumber;   // n of tip NNn; 0 for the other nodes
+    std::vector<BranchEvent> _events;   // root event first
+
+    const TreeStore* _simulated;
+
+    // Per simulated node
+    std::vector<uint32_t> _records;     // fossils on the branch and below it
+    std::vector<double> _lastFossil;    // time of the last fossil on the branch
+    std::vector<NodeIndex> _sampledNode; // node of this tree on whose branch it lies
+    std::vector<double> _uniforms;      // positions of the fossils on a branch
+    std::vector<std::pair<NodeIndex, NodeIndex> > _stack;  // (simulated node, parent)
+
+    void countRecordsBelow();
+    void prune();
+    NodeIndex skipUnaryNodes(NodeIndex x) const;
+
+public:
+
+    SampledTree();
+
+    // Draws the fossils and extant samples from random and builds the tree
+    void sampleFossils(const TreeStore* simulated, MbRandom* random, double psi, double rho);
+    void keepExtant(const SampledTree& sampled);
+    
+    // tree is the tree that was sampled
+    void remapEvents(SimTree* tree);
+
+    // Empty if nothing was sampled
+    const TreeStore* getTreeStore() const;
+    NodeIndex getRoot() const;
+
+    NodeIndex getSource(NodeIndex x) const;
+    const TreeStore* getSimulatedTree() const;
+
+    // True for the tips NNn, which are internal nodes of the simulated tree
+    bool getIsFossilTip(NodeIndex x) const;
+    uint32_t getTipNumber(NodeIndex x) const;
+    
+    int getNumberOfEvents() const;
+    const BranchEvent& getEvent(int i) const;
+};
+
+
+inline const TreeStore* SampledTree::getTreeStore() const
+{
+    return &_nodes;
+}
+
+inline NodeIndex SampledTree::getRoot() const
+{
+    return _nodes.size() > 0 ? 0 : NoNode;
+}
+
+inline NodeIndex SampledTree::getSource(NodeIndex x) const
+{
+    return _source[x];
+}
+
+inline const TreeStore* SampledTree::getSimulatedTree() const
+{
+    return _simulated;
+}
+
+inline bool SampledTree::getIsFossilTip(NodeIndex x) const
+{
+    return _tipNumber[x] != 0;
+}
+
+inline uint32_t SampledTree::getTipNumber(NodeIndex x) const
+{
+    return _tipNumber[x];
+}
+
+inline int SampledTree::getNumberOfEvents() const
+{
+    return (int)_events.size();
+}
+
+inline const BranchEvent& SampledTree::getEvent(int i) const
+{
+    return _events[i];
+}
+
+
+#endif /* defined(__simBAMM__SampledTree__) */
@@ -100,9 +100,30 @@ void Settings::initializeGlobalSettings()
     addParameter("maxTimeForEvent", "-1", NotRequired);
     addParameter("overwrite", "1", NotRequired);
     addParameter("inc", "0.1", NotRequired);
+    addParameter("simulationEngine", "discrete", NotRequired);
     addParameter("numberOfSims", "-1");
     addParameter("treefile", "-1");
     addParameter("eventfile", "-1");
+    addParameter("streamOutput", "0", NotRequired);
+    addParameter("outputFlushFreq", "100", NotRequired);
+    addParameter("outputPrecision", "6", NotRequired);
+    addParameter("outputFormat", "text", NotRequired);
+    addParameter("compression", "auto", NotRequired);
+    addParameter("archivefile", "simtrees.sta", NotRequired);
+    addParameter("fossiltreefile", "none", NotRequired);
+    addParameter("fossileventfile", "none", NotRequired);
+    addParameter("extanttreefile", "none", NotRequired);
+    addParameter("extanteventfile", "none", NotRequired);
+    addParameter("psi", "0", NotRequired);
+    addParameter("rho", "1", NotRequired);
+    addParameter("sweepTable", "none", NotRequired);
+    addParameter("sweepGrid", "none", NotRequired);
+    addParameter("sweepConfigFile", "sweep_configs.csv", NotRequired);
+    addParameter("metricsfile", "none", NotRequired);
+    addParameter("metricsInterval", "0", NotRequired);
+    addParameter("checkpointfile", "none", NotRequired);
+    addParameter("checkpointFreq", "1000", NotRequired);
+    addParameter("resume", "0", NotRequired);
     
     addParameter("rmin", "-1", NotRequired);
     addParameter("rmax", "-1", NotRequired);
@@ -123,6 +144,11 @@ void Settings::initializeGlobalSettings()
     addParameter("maxNumberOfShifts", "-1");
     
     addParameter("seed", "-1");
+    addParameter("rngEngine", "philox", NotRequired);
+    addParameter("threads", "1", NotRequired);
+    addParameter("shard", "none", NotRequired);
+    addParameter("onlySim", "0", NotRequired);
+    addParameter("printRejectedAttempts", "0", NotRequired);
     
     
     
@@ -336,6 +362,17 @@ void Settings::checkAllSettingsAreUserDefined() const
 }
 
 
+void Settings::set(const std::string& name, const std::string& value)
+{
+    ParameterMap::iterator it = _parameters.find(name);
+    if (it == _parameters.end()) {
+        log(Error) << "Parameter <<" << name << ">> does not exist.\n";
+        std::exit(1);
+    }
+    (it->second).setStringValue(value);
+}
+
+
 void Settings::checkAllOutputFilesAreWriteable() const
 {
     if (!get<bool>("overwrite")) {
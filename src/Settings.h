@@ -27,6 +27,9 @@ public:
     std::string get(const std::string& name) const;
     template<typename T> T get(const std::string& name) const;
 
+    // Replaces the value of a parameter; exits if it does not exist
+    void set(const std::string& name, const std::string& value);
+
     void printCurrentSettings(std::ostream& out = std::cout) const;
 
 private:
@@ -0,0 +1,112 @@
+//
+//  SimArena.cpp
+//  simBAMM
+//
+
+#include "SimArena.h"
+
+
+ArenaStatistics::ArenaStatistics() :
+    objects{0},
+    bytes{0},
+    blocks{0},
+    resets{0},
+    peakBytes{0}
+{
+}
+
+
+void ArenaStatistics::add(const ArenaStatistics& x)
+{
+    objects += x.objects;
+    bytes += x.bytes;
+    blocks += x.blocks;
+    resets += x.resets;
+    if (x.peakBytes > peakBytes){
+        peakBytes = x.peakBytes;
+    }
+}
+
+
+SimArena::SimArena(std::size_t blockSize) :
+    _blocks{},
+    _blockSize{blockSize},
+    _currentBlock{0},
+    _offset{0},
+    _bytesInUse{0},
+    _treeStore{},
+    _statistics{}
+{
+}
+
+
+SimArena::~SimArena()
+{
+    for (std::size_t i = 0; i < _blocks.size(); i++){
+        delete[] _blocks[i];
+    }
+}
+
+
+void* SimArena::allocate(std::size_t size, std::size_t alignment)
+{
+    std::size_t start = (_offset + alignment - 1) & ~(alignment - 1);
+    
+    if (_blocks.empty() || start + size > _blockSize){
+        // Move on to the next block, keeping the ones from earlier attempts
+        if (!_blocks.empty()){
+            _currentBlock++;
+        }
+        if (_currentBlock == _blocks.size()){
+            _blocks.push_back(new char[_blockSize]);
+            _statistics.blocks++;
+        }
+        start = 0;
+    }
+    
+    _offset = start + size;
+    _bytesInUse += size;
+    
+    _statistics.objects++;
+    _statistics.bytes += size;
+    if (_bytesInUse > _statistics.peakBytes){
+        _statistics.peakBytes = _bytesInUse;
+    }
+    
+    return _blocks[_currentBlock] + start;
+}
+
+
+void SimArena::reset()
+{
+    countNodes(_statistics);
+    _treeStore.clear();
+    
+    _currentBlock = 0;
+    _offset = 0;
+    _bytesInUse = 0;
+    _statistics.resets++;
+}
+
+
+// Includes the nodes of the current attempt, which are only added
+//   to _statistics when the arena is reset
+
+ArenaStatistics SimArena::getStatistics() const
+{
+    ArenaStatistics x = _statistics;
+    countNodes(x);
+    return x;
+}
+
+
+void SimArena::countNodes(ArenaStatistics& x) const
+{
+    long nodeBytes = (long)_treeStore.size() * TreeStore::BytesPerNode;
+    
+    x.objects += _treeStore.size();
+    x.bytes += nodeBytes;
+    if (_bytesInUse + nodeBytes > x.peakBytes){
+        x.peakBytes = _bytesInUse + nodeBytes;
+    }
+}
@@ -0,0 +1,87 @@
+//
+//  SimArena.h
+//  simBAMM
+//
+
+#ifndef __simBAMM__SimArena__
+#define __simBAMM__SimArena__
+
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "TreeStore.h"
+
+
+// Allocation counts of one or more arenas
+struct ArenaStatistics
+{
+    long    objects;        // objects created
+    long    bytes;          // bytes handed out to those objects
+    long    blocks;         // blocks obtained from the system allocator
+    long    resets;         // times the arena was rewound
+    long    peakBytes;      // largest number of bytes in use at once
+
+    ArenaStatistics();
+    void add(const ArenaStatistics& x);
+};
+
+
+// Memory for the nodes and events of simulated trees.
+// Nodes live in the arena's TreeStore; other objects are carved out of
+//   large blocks and never freed one by one. reset() rewinds the arena
+//   in constant time and keeps its blocks and node arrays for the next
+//   attempt. Destructors are not run by the arena.
+
+class SimArena
+{
+
+private:
+
+    std::vector<char*> _blocks;
+    std::size_t _blockSize;
+    std::size_t _currentBlock;
+    std::size_t _offset;
+    long _bytesInUse;
+
+    TreeStore _treeStore;
+
+    ArenaStatistics _statistics;
+
+    void countNodes(ArenaStatistics& x) const;
+
+    void* allocate(std::size_t size, std::size_t alignment);
+
+public:
+
+    explicit SimArena(std::size_t blockSize = 256 * 1024);
+    SimArena(const SimArena&) = delete;
+    SimArena& operator=(const SimArena&) = delete;
+    ~SimArena();
+
+    template<typename T, typename... Args> T* create(Args&&... args);
+
+    TreeStore* getTreeStore();
+
+    void reset();
+
+    ArenaStatistics getStatistics() const;
+};
+
+
+template<typename T, typename... Args>
+inline T* SimArena::create(Args&&... args)
+{
+    void* p = allocate(sizeof(T), alignof(T));
+    return new (p) T(std::forward<Args>(args)...);
+}
+
+
+inline TreeStore* SimArena::getTreeStore()
+{
+    return &_treeStore;
+}
+
+
+#endif /* defined(__simBAMM__SimArena__) */
@@ -8,32 +8,43 @@
 
 #include <set>
 #include <vector>
-#include <sstream>
+#include <algorithm>
+#include <cmath>
 
 #include "SimTree.h"
+#include "SampledTree.h"
 #include "BranchEvent.h"
 #include "MbRandom.h"
-#include "Node.h"
-#include "Settings.h"
+#include "SimulationConfig.h"
+#include "SimArena.h"
 
 
-#define SAMPLE_EXPONENTIAL
 
 
-
-
-SimTree::SimTree(MbRandom* random, Settings* settings) :
+SimTree::SimTree(MbRandom* random, const SimulationConfig* config, SimArena* arena) :
     _random{random},
-    _settings{settings},
-    _root{new Node},
+    _config{config},
+    _ownedArena{arena == nullptr ? new SimArena : nullptr},
+    _arena{arena == nullptr ? _ownedArena : arena},
+    _nodes{_arena->getTreeStore()},
+    _root{NoNode},
     _rootEvent{nullptr},
     _eventSet{},
-    _nodes{},
+    _fossilTree{nullptr},
+    _extantTree{nullptr},
+    _pending{},
     _maxTime{0.0},
     _maxTimeForEvent{0.0},
     _maxNumberOfNodes{0},
+    _maxNumberOfTips{0},
+    _maxNumberOfShifts{0},
+    _numberOfTips{0},
+    _numberOfSteps{0},
     _isTreeBad{false},
+    _rejectionReason{NotRejected},
+    _isExactEngine{false},
     _inc{0.0},
+    _eventRate{0.0},
     _multipliermin{0.0},
     _multipliermax{0.0},
     _epsmin{0.0},
@@ -42,28 +53,28 @@ SimTree::SimTree(MbRandom* random, Settings* settings) :
     _rmax{0.0}
 {
     
-    BranchEvent* be = new BranchEvent;
+    BranchEvent* be = _arena->create<BranchEvent>();
     _rootEvent = be;
     
     // Initialize parameters of the root event:
-    _rootEvent->setEventNode(_root);
+    _rootEvent->setEventNode(0);
     _rootEvent->setEventTime(0.0);
     
     // Rate distribution parameters
     
     
-    _epsmin  = _settings->get<double>("epsmin");
-    _epsmax = _settings->get<double>("epsmax");
+    _epsmin  = _config->epsmin;
+    _epsmax = _config->epsmax;
     
-    _rmin = _settings->get<double>("rmin");
-    _rmax = _settings->get<double>("rmax");
+    _rmin = _config->rmin;
+    _rmax = _config->rmax;
     
-    double lambdaInit = _settings->get<double>("lambdaInit0");
-    double lambdaShift = _settings->get<double>("lambdaShift0");
-    double muInit = _settings->get<double>("muInit0");
+    double lambdaInit = _config->lambdaInit0;
+    double lambdaShift = _config->lambdaShift0;
+    double muInit = _config->muInit0;
     
-    _lambda_rate =  1 / _settings->get<double>("lambdaExpMean");
-    _mu_rate = 1 / _settings->get<double>("muExpMean");
+    _lambda_rate =  1 / _config->lambdaExpMean;
+    _mu_rate = 1 / _config->muExpMean;
 
 #ifdef SAMPLE_EXPONENTIAL
     
@@ -79,7 +90,7 @@ SimTree::SimTree(MbRandom* random, Settings* settings) :
     if (lambdaInit <= 0){
         double eps = _random->uniformRv(_epsmin, _epsmax);
         double r = 0.0;
-        if (_settings->get<bool>("rInitLogscale")){
+        if (_config->rInitLogscale){
             double tmp = _random->uniformRv(std::log(_rmin), std::log(_rmax));
             r = std::exp(tmp);
         }else{
@@ -108,74 +119,110 @@ SimTree::SimTree(MbRandom* random, Settings* settings) :
     _rootEvent->setLambdaShift(lambdaShift);
     _rootEvent->setMuInit(muInit);
     
-    _root->setAnc(NULL);
-    _root->setTime(0.0);
-    _root->setNodeEvent(be);
-
-    _nodes.push_back(_root);
-    
-    _maxTime = _settings->get<double>("maxTime");
-    _maxNumberOfNodes = _settings->get<double>("maxNumberOfNodes");
-    _maxTimeForEvent = _settings->get<double>("maxTimeForEvent");
+    _root = _nodes->addNode(NoNode, 0.0, 0);
     
-    if (_maxTimeForEvent <= 0.0){
-        _maxTimeForEvent = _maxTime;
-    }
+    _maxTime = _config->maxTime;
+    _maxNumberOfNodes = _config->maxNumberOfNodes;
+    _maxNumberOfTips = _config->maxtaxa;
+    _maxNumberOfShifts = _config->maxNumberOfShifts;
+    _maxTimeForEvent = _config->maxTimeForEvent;
     
-    _inc = _settings->get<double>("inc");
+    _inc = _config->inc;
+    _eventRate = _config->eventRate;
     
+    _isExactEngine = (_config->simulationEngine == ExactEngine);
     
-    simulateStep(_root, "right");
- 
-    if (!_isTreeBad){
-        simulateStep(_root, "left");   
-    }
-
+    simulateTree();
     
-    if (!_isTreeBad){
-        setTipNames();
-        //std::cout << "random tips: " << std::endl;
-        //std::cout << _root->getRandomTipLeft(_root) << std::endl;
-        //std::cout << _root->getRandomTipRight(_root) << std::endl;
-    }
- 
+    // Tip names are set by the engine once the tree is accepted
     
 }
 
 
+// Nodes and events of a tree allocated from another arena are left
+//   alone: the arena is rewound for the next attempt.
+
 SimTree::~SimTree()
 {
+    delete _fossilTree;
+    delete _extantTree;
+    delete _ownedArena;
+}
 
-    
-    for (int i = 0; i < (int)_eventSet.size(); ++i){
-        delete _eventSet[i];
-    }
-    
-    for (int i = 0; i < (int)_nodes.size(); ++i){
-        delete _nodes[i];
-    }
-    
-    delete _rootEvent;
-     
+
+void SimTree::setFossilTree(SampledTree* tree)
+{
+    delete _fossilTree;
+    _fossilTree = tree;
+}
+
+
+void SimTree::setExtantTree(SampledTree* tree)
+{
+    delete _extantTree;
+    _extantTree = tree;
+}
+
+
+// Takes ownership of the arena the tree was allocated from
+
+void SimTree::adoptArena(SimArena* arena)
+{
+    _ownedArena = arena;
 }
 
 
 
-// Recursive simulation engine
+// Grows the tree from the root with an explicit stack of pending branches.
+// The right branch of a node is taken before the left one, so the
+//   random numbers are used, and the nodes created, in the same order
+//   as a depth-first recursion would.
 
-void SimTree::simulateStep(Node* p, std::string direction)
+void SimTree::simulateTree()
 {
+    _pending.clear();
+    _pending.push_back(PendingLineage{_root, LeftChild});
+    _pending.push_back(PendingLineage{_root, RightChild});
     
-    if ((int)_nodes.size() > _maxNumberOfNodes){
-        _isTreeBad = true;
-        return;
+    while (!_pending.empty() && !_isTreeBad){
+        
+        if (_nodes->size() > _maxNumberOfNodes){
+            rejectAttempt(TooManyNodes);
+            return;
+        }
+        
+        PendingLineage x = _pending.back();
+        _pending.pop_back();
+        
+        NodeIndex progeny = NoNode;
+        if (_isExactEngine){
+            progeny = simulateStepExact(x.parent, x.side);
+        }else{
+            progeny = simulateStep(x.parent, x.side);
+        }
+        
+        // speciation: both daughter branches are still to be simulated
+        if (progeny != NoNode && !_isTreeBad){
+            _pending.push_back(PendingLineage{progeny, LeftChild});
+            _pending.push_back(PendingLineage{progeny, RightChild});
+        }
     }
+}
+
+
+// Discrete-time simulation engine
+//
+// Simulates the branch from p on the given side until it ends.
+// Returns the new node if the branch ends in speciation, NoNode otherwise.
+
+NodeIndex SimTree::simulateStep(NodeIndex p, ChildSide side)
+{
     
-    double curTime = p->getTime();
+    double curTime = _nodes->getTime(p);
     double dt = 0;
-    double eventRate = _settings->get<double>("eventRate");
+    double eventRate = _eventRate;
     
-    BranchEvent* curEvent = p->getNodeEvent();
+    BranchEvent* curEvent = getNodeEvent(p);
     double eventtime = curEvent->getEventTime();
 
     bool notDone = true;
@@ -190,6 +237,8 @@ void SimTree::simulateStep(Node* p, std::string direction)
     
     while (notDone){
     
+        _numberOfSteps++;
+        
         if (curTime + _inc > _maxTime){
             local_inc = _maxTime - curTime;
         }
@@ -217,37 +266,23 @@ void SimTree::simulateStep(Node* p, std::string direction)
                                
                 notDone = false;
                 
-                Node* progeny = new Node(p, curTime, curEvent);
-                _nodes.push_back(progeny);
-                
-                progeny->setBrlen((curTime - p->getTime()));
-                
-                if (direction == "right"){
-                    p->setRtDesc(progeny);
-                }else if (direction == "left"){
-                    p->setLfDesc(progeny);
-                }else{
-                    throw;
-                }
+                NodeIndex progeny = addProgeny(p, side, curTime);
                 
                 if (insertNewEvent){
                     // Here we link the new node
                     //   to the new event that occurred on the branch
-                    BranchEvent* nextEvent
-                            = new BranchEvent(progeny, eventtime, lambdainit, lambdashift, mu);
+                    BranchEvent* nextEvent = _arena->create<BranchEvent>
+                            (progeny, eventtime, lambdainit, lambdashift, mu);
                     
-                    _eventSet.push_back(nextEvent);
-                    progeny->setNodeEvent(nextEvent);
+                    addShift(nextEvent);
                 }
                 
                 
                 if (eventtype == (int)1){
-                    simulateStep(progeny, "right");
-                    simulateStep(progeny, "left");
+                    return progeny;
                 }else{
                     // extinction.
-                    progeny->setIsExtant(false);
-                    progeny->setIsTip(true);
+                    addTip(progeny, false);
                 }
                 
 
@@ -257,23 +292,9 @@ void SimTree::simulateStep(Node* p, std::string direction)
 
                 eventtime = curTime;
                 
-#ifdef SAMPLE_EXPONENTIAL
-                
-                lambdainit = _random->exponentialRv(_lambda_rate);
-                mu = _random->exponentialRv(_mu_rate);
+                drawShiftRates(lambdainit, mu);
                 lambdashift = 0.0;
                 
-#else
- 
-                double new_r = _random->uniformRv(_rmin, _rmax);
-                double new_eps = _random->uniformRv(_epsmin, _epsmax);
-    
-                
-                lambdainit = new_r / (1 - new_eps);
-                mu = new_eps * lambdainit;
-
-#endif
-                
                 insertNewEvent = true;
                 
             }else{
@@ -295,18 +316,8 @@ void SimTree::simulateStep(Node* p, std::string direction)
             
             curTime = _maxTime;
             notDone = false;
-            Node* progeny = new Node(p, curTime, curEvent);
-            _nodes.push_back(progeny);
-            
-            if (direction == "right"){
-                p->setRtDesc(progeny);
-            }else{
-                p->setLfDesc(progeny);
-            }
-            
-            progeny->setIsTip(true);
-            progeny->setIsExtant(true);
-            progeny->setBrlen((curTime - p->getTime()));
+            NodeIndex progeny = addProgeny(p, side, curTime);
+            addTip(progeny, true);
             
         }else{
             std::cout << "reached problem point in SimTree::simulateStep()" << std::endl;
@@ -319,134 +330,262 @@ void SimTree::simulateStep(Node* p, std::string direction)
     
     }
     
-
+    return NoNode;
 }
 
 
 
-void SimTree::printTipLambda()
+// Exact (event-driven) simulation engine
+//
+// Draws the waiting time to the next speciation, extinction or shift
+//   on the lineage directly from the total rate. Lineages are independent,
+//   so each one is followed to its end as in simulateStep().
+// With constant rates this takes one draw per event. When lambda varies
+//   in time (lambdaShift0 != 0), candidate events are drawn by thinning
+//   from the rate bound over a window of length inc.
+
+NodeIndex SimTree::simulateStepExact(NodeIndex p, ChildSide side)
 {
-    for (int i = 0; i < (int)_nodes.size(); i++){
-        if (_nodes[i]->getIsTip()){
-            std::cout << i << "\t" << _nodes[i]->getNodeEvent()->getLambdaInit() << std::endl;
+    
+    double curTime = _nodes->getTime(p);
+    double eventRate = _eventRate;
+    
+    BranchEvent* curEvent = getNodeEvent(p);
+    double eventtime = curEvent->getEventTime();
+
+    bool insertNewEvent = false;
+ 
+    double lambdainit = curEvent->getLambdaInit();
+    double lambdashift = curEvent->getLambdaShift();
+    double mu = curEvent->getMuInit();
+    
+    while (true){
+        
+        _numberOfSteps++;
+        
+        if (curTime >= _maxTimeForEvent){
+            eventRate = 0.0;
+        }
+        
+        // Shifts stop at _maxTimeForEvent: rates are constant up to there
+        double horizon = _maxTime;
+        if (eventRate > 0.0 && _maxTimeForEvent < _maxTime){
+            horizon = _maxTimeForEvent;
         }
+        
+        double lambda = lambdainit * std::exp(lambdashift * (curTime - eventtime));
+        double bound = lambda + mu + eventRate;
+        
+        if (lambdashift != 0.0){
+            // Thinning: lambda is monotonic, so its largest value
+            //   on the window is at one of the two ends.
+            if (curTime + _inc < horizon){
+                horizon = curTime + _inc;
+            }
+            double lambdaEnd = lambdainit * std::exp(lambdashift * (horizon - eventtime));
+            bound = std::max(lambda, lambdaEnd) + mu + eventRate;
+        }
+        
+        double dt = _random->exponentialRv(bound);
+        
+        if (curTime + dt >= horizon){
+            curTime = horizon;
+            if (curTime < _maxTime){
+                continue;
+            }
+            
+            // lineage reaches max time
+            NodeIndex progeny = addProgeny(p, side, _maxTime);
+            addTip(progeny, true);
+            return NoNode;
+        }
+        
+        curTime += dt;
+        
+        if (lambdashift != 0.0){
+            lambda = lambdainit * std::exp(lambdashift * (curTime - eventtime));
+            if (_random->uniformRv() * bound > lambda + mu + eventRate){
+                continue;   // rejected candidate
+            }
+        }
+        
+        int eventtype = getEventType(lambda, mu, eventRate);
+        
+        if (eventtype == 3){
+            // Rate shift but no speciation-extinction
+            eventtime = curTime;
+            drawShiftRates(lambdainit, mu);
+            lambdashift = 0.0;
+            insertNewEvent = true;
+            continue;
+        }
+        
+        // speciation or extinction
+        NodeIndex progeny = addProgeny(p, side, curTime);
+        
+        if (insertNewEvent){
+            BranchEvent* nextEvent = _arena->create<BranchEvent>
+                    (progeny, eventtime, lambdainit, lambdashift, mu);
+            addShift(nextEvent);
+        }
+        
+        if (eventtype == 1){
+            return progeny;
+        }
+        
+        addTip(progeny, false);
+        return NoNode;
     }
-
 }
 
 
-int SimTree::getEventType(double x, double y, double z)
+// Creates the node that ends the branch from p on the given side.
+// It inherits the regime of p until a shift is recorded on the branch.
+
+NodeIndex SimTree::addProgeny(NodeIndex p, ChildSide side, double time)
 {
-    double total = x + y + z;
+    NodeIndex progeny = _nodes->addNode(p, time, _nodes->getRegime(p));
     
-    double ran = _random->uniformRv();
-    
-    int eventtype = 0;
+    if (side == RightChild){
+        _nodes->setRtDesc(p, progeny);
+    }else{
+        _nodes->setLfDesc(p, progeny);
+    }
+    return progeny;
+}
+
+
+// Marks x as a tip and abandons the attempt once there are too many
+
+void SimTree::addTip(NodeIndex x, bool isExtant)
+{
+    _nodes->setStatus(x, true, isExtant);
     
-    if (ran <= (x/total)){
-        eventtype = 1;
-    }else if (ran <= ((x + y) / total)){
-        eventtype = 2;
-    }else {
-        eventtype = 3;
+    _numberOfTips++;
+    if (_numberOfTips > _maxNumberOfTips){
+        rejectAttempt(TooManyTips);
     }
-    return eventtype;
 }
 
 
-void SimTree::setTipNames()
+// Records a shift, which becomes the regime of the node at the end of
+//   its branch, and abandons the attempt once there are too many
+
+void SimTree::addShift(BranchEvent* x)
 {
+    _eventSet.push_back(x);
+    _nodes->setRegime(x->getEventNode(), (uint32_t)_eventSet.size());
     
-    for (int i = 0; i < (int)_nodes.size(); i++){
-        std::stringstream ss;
-        if (_nodes[i]->getIsTip() & _nodes[i]->getIsExtant()){
-            ss << "A" << i;
-            _nodes[i]->setName(ss.str());
-        }else if (_nodes[i]->getIsTip() & !_nodes[i]->getIsExtant()){
-            ss << "D" << i;
-            _nodes[i]->setName(ss.str());
-        }else{
-            ss << "I" << i;
-            _nodes[i]->setName(ss.str());
-        }
-        
+    if ((int)_eventSet.size() > _maxNumberOfShifts){
+        rejectAttempt(TooManyShifts);
     }
 }
 
 
-void SimTree::writeTree(Node* p, std::ostream& ss)
+// The simulation stops at the next check of _isTreeBad;
+//   the first reason found is the one recorded.
+
+void SimTree::rejectAttempt(RejectionReason reason)
 {
-    if (p->getLfDesc() == NULL && p-> getRtDesc() == NULL) {
-        ss << p->getName() << ":" << p->getBrlen();
-    } else {
-        ss << "(";
-        writeTree(p->getLfDesc(), ss);
-        ss << ",";
-        writeTree(p->getRtDesc(), ss);
-        ss << "):" << p->getBrlen();
+    if (!_isTreeBad){
+        _isTreeBad = true;
+        _rejectionReason = reason;
     }
 }
 
 
-int SimTree::getNumberOfTips()
+const char* rejectionReasonName(RejectionReason reason)
 {
-    int ctr = 0;
-    for (int i = 0; i < (int)_nodes.size(); i++){
-        if (_nodes[i]->getLfDesc() == NULL && _nodes[i]->getRtDesc() == NULL){
-            ctr++;
-        }
+    switch (reason){
+        case NotRejected:   return "accepted";
+        case TooManyNodes:  return "tooManyNodes";
+        case TooManyTips:   return "tooManyTips";
+        case TooManyShifts: return "tooManyShifts";
+        case TooFewTips:    return "tooFewTips";
+        case TooFewShifts:  return "tooFewShifts";
+        case TooYoung:      return "tooYoung";
+        default:            return "unknown";
     }
-    return ctr;
 }
 
 
-int SimTree::getNumberOfShifts()
+// Draws the rates of a new regime after a shift
+
+void SimTree::drawShiftRates(double& lambdainit, double& mu)
 {
-    int shifts = (int)_eventSet.size();
-    return shifts;
+#ifdef SAMPLE_EXPONENTIAL
+    
+    lambdainit = _random->exponentialRv(_lambda_rate);
+    mu = _random->exponentialRv(_mu_rate);
+    
+#else
+    
+    double new_r = _random->uniformRv(_rmin, _rmax);
+    double new_eps = _random->uniformRv(_epsmin, _epsmax);
+    
+    lambdainit = new_r / (1 - new_eps);
+    mu = new_eps * lambdainit;
+    
+#endif
 }
 
 
-void SimTree::getEventDataString(int index, std::ostream& ss)
+void SimTree::printTipLambda()
 {
+    for (int i = 0; i < _nodes->size(); i++){
+        if (_nodes->getIsTip(i)){
+            std::cout << i << "\t" << getNodeEvent(i)->getLambdaInit() << std::endl;
+        }
+    }
 
-    BranchEvent* be = _rootEvent;
-    
-    ss << index << ",";
-    ss << be->getEventNode()->getRandomTipRight(be->getEventNode()) << ",";
-    ss << be->getEventNode()->getRandomTipLeft(be->getEventNode()) << ",";
-    ss << be->getEventTime() << ",";
-    ss << be->getLambdaInit() << ",";
-    ss << be->getLambdaShift() << ",";
-    ss << be->getMuInit() << "\n";
-    
-    for (int i = 0; i < (int)_eventSet.size(); i++){
-        be = _eventSet[i];
-        ss << index << ",";
-        ss << be->getEventNode()->getRandomTipRight(be->getEventNode()) << ",";
-        ss << be->getEventNode()->getRandomTipLeft(be->getEventNode()) << ",";
-        ss << be->getEventTime() << ",";
-        ss << be->getLambdaInit() << ",";
-        ss << be->getLambdaShift() << ",";
-        ss << be->getMuInit() << "\n";
+}
+
+
+int SimTree::getEventType(double x, double y, double z)
+{
+    double total = x + y + z;
+    
+    double ran = _random->uniformRv();
+    
+    int eventtype = 0;
+    
+    if (ran <= (x/total)){
+        eventtype = 1;
+    }else if (ran <= ((x + y) / total)){
+        eventtype = 2;
+    }else {
+        eventtype = 3;
     }
+    return eventtype;
+}
+
 
+int SimTree::getNumberOfTips()
+{
+    return _numberOfTips;
 }
 
 
+int SimTree::getNumberOfShifts()
+{
+    int shifts = (int)_eventSet.size();
+    return shifts;
+}
+
 
 void SimTree::recursiveCheckTime()
 {
-    recursiveSetTime(getRoot());
+    std::vector<double> times(_nodes->size(), 0.0);
+    recursiveSetTime(getRoot(), times);
     
-    for (int i = 0; i < static_cast<int>(_nodes.size()); i++){
-        double t1 = _nodes[i]->getTime();
-        double t2 = _nodes[i]->getTmp();
+    for (int i = 0; i < _nodes->size(); i++){
+        double t1 = _nodes->getTime(i);
+        double t2 = times[i];
         
         double dt = (double)fabs(t1 - t2);
         
         if (dt > 0.00001){
-            std::cout << _nodes[i] << "\t" << t1 << "\t" << t2 << std::endl;
+            std::cout << i << "\t" << t1 << "\t" << t2 << std::endl;
         }
         
     }
@@ -456,17 +595,16 @@ void SimTree::recursiveCheckTime()
 
 
 
-void SimTree::recursiveSetTime(Node * x)
+void SimTree::recursiveSetTime(NodeIndex x, std::vector<double>& times)
 {
     if (x == getRoot()){
-        x->setTmp(0.0);
+        times[x] = 0.0;
     }else{
-        double tm = x->getAnc()->getTmp() + x->getBrlen();
-        x->setTmp(tm);
+        times[x] = times[_nodes->getParent(x)] + _nodes->getBrlen(x);
     }
-    if (x->getLfDesc() != NULL && x->getRtDesc() != NULL) {
-        recursiveSetTime(x->getLfDesc());
-        recursiveSetTime(x->getRtDesc());
+    if (_nodes->getLfDesc(x) != NoNode && _nodes->getRtDesc(x) != NoNode) {
+        recursiveSetTime(_nodes->getLfDesc(x), times);
+        recursiveSetTime(_nodes->getRtDesc(x), times);
     }
 
 }
@@ -474,18 +612,19 @@ void SimTree::recursiveSetTime(Node * x)
 
 void SimTree::checkBranchLengths()
 {
-    for (int i = 0; i < static_cast<int>(_nodes.size()); i++){
-        if (_nodes[i] != getRoot()){
-            double btemp = _nodes[i]->getTime() - _nodes[i]->getAnc()->getTime();
-            double dt = (double)fabs(_nodes[i]->getBrlen() - btemp );
+    for (int i = 0; i < _nodes->size(); i++){
+        if ((NodeIndex)i != getRoot()){
+            double parentTime = _nodes->getTime(_nodes->getParent(i));
+            double btemp = _nodes->getTime(i) - parentTime;
+            double dt = (double)fabs(_nodes->getBrlen(i) - btemp );
             if (dt > 0.001){
-                std::cout << _nodes[i]->getTime() << "\t" << _nodes[i]->getBrlen() << "\tNewBL:  ";
+                std::cout << _nodes->getTime(i) << "\t" << _nodes->getBrlen(i) << "\tNewBL:  ";
                 std::cout << btemp << std::endl;
             }
             
-            if (_nodes[i]->getBrlen() <= 0){
-                std::cout << "badBranchLength:\t" << _nodes[i]->getTime() << "\t";
-                std::cout << _nodes[i]->getBrlen() << "\tPar_age: " << _nodes[i]->getAnc()->getTime() <<  std::endl;
+            if (_nodes->getBrlen(i) <= 0){
+                std::cout << "badBranchLength:\t" << _nodes->getTime(i) << "\t";
+                std::cout << _nodes->getBrlen(i) << "\tPar_age: " << parentTime <<  std::endl;
         }
         }
 
@@ -501,15 +640,10 @@ void SimTree::checkBranchLengths()
 double SimTree::getTreeAge()
 {
     double max_age = 0.0;
-    for (int i = 0; i < static_cast<int>(_nodes.size()); i++){
-        if (_nodes[i]->getTime() > max_age){
-            max_age = _nodes[i]->getTime();
+    for (int i = 0; i < _nodes->size(); i++){
+        if (_nodes->getTime(i) > max_age){
+            max_age = _nodes->getTime(i);
         }
     }
     return max_age;
 }
-
-
-
-
-
@@ -13,33 +13,88 @@
 #include <set>
 #include <vector>
 #include <sstream>
+#include <string>
+
+#include "TreeStore.h"
 
-class Node;
 class BranchEvent;
 class MbRandom;
-class Settings;
+class SampledTree;
+class SimArena;
+struct SimulationConfig;
+
+// Why a simulated tree was rejected
+enum RejectionReason {
+    NotRejected,
+    TooManyNodes,
+    TooManyTips,
+    TooManyShifts,
+    TooFewTips,
+    TooFewShifts,
+    TooYoung,
+    NumberOfRejectionReasons
+};
+
+const char* rejectionReasonName(RejectionReason reason);
+
+// Side of the parent node on which a new branch grows
+enum ChildSide {
+    RightChild,
+    LeftChild
+};
+
+// A branch still to be simulated: it starts at the parent node
+struct PendingLineage {
+    NodeIndex parent;
+    ChildSide side;
+};
 
 class SimTree
 {
 private:
     
     MbRandom* _random;
-    Settings* _settings;
+    const SimulationConfig* _config;
+    
+    // Nodes and events are allocated from the arena; the tree frees them
+    //   only if it owns the arena (see adoptArena)
+    SimArena* _ownedArena;
+    SimArena* _arena;
+    
+    TreeStore* _nodes;  // the arena's node arrays
     
-    Node* _root;
+    NodeIndex _root;
     BranchEvent* _rootEvent;
     
     std::vector<BranchEvent*> _eventSet; // holds all non-root events
-    std::vector<Node*> _nodes;
+    
+    SampledTree* _fossilTree;   // owned; set by the engine once accepted
+    SampledTree* _extantTree;   //   likewise
+    
+    // Work stack of branches still to be simulated
+    std::vector<PendingLineage> _pending;
     
     double  _maxTime;
 
     double  _maxTimeForEvent;
     int     _maxNumberOfNodes;
+    int     _maxNumberOfTips;
+    int     _maxNumberOfShifts;
+    
+    // Live counters, checked against the limits as the tree grows
+    //   so that an attempt is abandoned as soon as it cannot be accepted
+    int     _numberOfTips;
+    
+    long    _numberOfSteps;     // iterations of the simulateStep loops
     
     bool    _isTreeBad;
+    RejectionReason _rejectionReason;
+    
+    // Exact event-driven simulation instead of the inc discretization
+    bool    _isExactEngine;
     
     double  _inc;
+    double  _eventRate;
     
     double _multipliermin;
     double _multipliermax;
@@ -54,28 +109,50 @@ private:
     
 public:
     
-    SimTree(MbRandom* random, Settings* settings);
+    SimTree(MbRandom* random, const SimulationConfig* config, SimArena* arena = nullptr);
     SimTree(const SimTree&) = delete;
     SimTree& operator=(const SimTree&) = delete;
     ~SimTree();
 
-    void simulateStep(Node* p, std::string direction);
+    void simulateTree();
+    NodeIndex simulateStep(NodeIndex p, ChildSide side);
+    NodeIndex simulateStepExact(NodeIndex p, ChildSide side);
+
+    NodeIndex addProgeny(NodeIndex p, ChildSide side, double time);
+    void drawShiftRates(double& lambdainit, double& mu);
+    
+    void addTip(NodeIndex x, bool isExtant);
+    void addShift(BranchEvent* x);
+    void rejectAttempt(RejectionReason reason);
 
     int getEventType(double a, double b, double c);
     
-    void writeTree(Node* p, std::ostream& ss);
-    void setTipNames(void);
-    Node* getRoot();
-    void printTipLambda();
+    void adoptArena(SimArena* arena);
+    
+    // Takes ownership of the tree's fossil record (see SampledTree)
+    void setFossilTree(SampledTree* tree);
+    const SampledTree* getFossilTree();
     
-    void getEventDataString(int index, std::ostream& ss);
+    // Takes ownership of the tree's reconstructed (extant-only) tree
+    void setExtantTree(SampledTree* tree);
+    const SampledTree* getExtantTree();
+    
+    NodeIndex getRoot();
+    TreeStore* getTreeStore();
+    BranchEvent* getNodeEvent(NodeIndex x);
+    BranchEvent* getRootEvent();
+    BranchEvent* getShiftEvent(int i);
+    void printTipLambda();
     
     bool getIsTreeBad();
+    RejectionReason getRejectionReason();
+    void setRejectionReason(RejectionReason reason);
     int getNumberOfTips();
     int getNumberOfShifts();
+    long getNumberOfSteps();
     
     void recursiveCheckTime();
-    void recursiveSetTime(Node * x);
+    void recursiveSetTime(NodeIndex x, std::vector<double>& times);
     void checkBranchLengths();
     
     double getTreeAge();
@@ -83,15 +160,63 @@ public:
 };
 
 
-inline Node* SimTree::getRoot()
+inline NodeIndex SimTree::getRoot()
 {
     return _root;
 }
 
+inline TreeStore* SimTree::getTreeStore()
+{
+    return _nodes;
+}
+
+// Regime 0 is the root event; regime k is the k-th shift
+
+inline BranchEvent* SimTree::getNodeEvent(NodeIndex x)
+{
+    uint32_t regime = _nodes->getRegime(x);
+    return regime == 0 ? _rootEvent : _eventSet[regime - 1];
+}
+
+inline BranchEvent* SimTree::getRootEvent()
+{
+    return _rootEvent;
+}
+
+inline BranchEvent* SimTree::getShiftEvent(int i)
+{
+    return _eventSet[i];
+}
+
+inline const SampledTree* SimTree::getFossilTree()
+{
+    return _fossilTree;
+}
+
+inline const SampledTree* SimTree::getExtantTree()
+{
+    return _extantTree;
+}
+
+inline long SimTree::getNumberOfSteps()
+{
+    return _numberOfSteps;
+}
+
 inline bool SimTree::getIsTreeBad()
 {
     return _isTreeBad;
 }
 
+inline RejectionReason SimTree::getRejectionReason()
+{
+    return _rejectionReason;
+}
+
+inline void SimTree::setRejectionReason(RejectionReason reason)
+{
+    _rejectionReason = reason;
+}
+
 
 #endif /* defined(__simBAMM__SimTree__) */
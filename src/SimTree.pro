@@ -3,28 +3,50 @@ CONFIG += console
 CONFIG -= app_bundle
 CONFIG -= qt
 QMAKE_CXXFLAGS += -std=c++11 -Wall -Wextra -Weffc++ -Werror
+DEFINES += SIMTREE_HAVE_ZLIB
+LIBS += -lz
 
 SOURCES += \
     main.cpp \
     BranchEvent.cpp \
+    Checkpoint.cpp \
     CommandLineProcessor.cpp \
+    GzipCompressor.cpp \
     Log.cpp \
     MbRandom.cpp \
-    Node.cpp \
+    OutputSink.cpp \
+    ParameterSweep.cpp \
+    RunMetrics.cpp \
+    SampledTree.cpp \
     Settings.cpp \
     SettingsParameter.cpp \
+    SimArena.cpp \
     SimTree.cpp \
-    SimTreeEngine.cpp
+    SimTreeEngine.cpp \
+    SimulationConfig.cpp \
+    TreeArchive.cpp \
+    TreeStore.cpp \
+    TreeWriter.cpp
 
 HEADERS += \
     BranchEvent.h \
+    Checkpoint.h \
     CommandLineProcessor.h \
+    GzipCompressor.h \
     Log.h \
     MatchPathSeparator.h \
     MbRandom.h \
-    Node.h \
+    OutputSink.h \
+    ParameterSweep.h \
+    RunMetrics.h \
+    SampledTree.h \
     Settings.h \
     SettingsParameter.h \
+    SimArena.h \
     SimTree.h \
-    SimTreeEngine.h
+    SimTreeEngine.h \
+    SimulationConfig.h \
+    TreeArchive.h \
+    TreeStore.h \
+    TreeWriter.h
 
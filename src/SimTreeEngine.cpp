@@ -10,55 +10,182 @@
 #include <iostream>
 #include <sstream>
 #include <fstream>
+#include <thread>
+#include <algorithm>
+#include <chrono>
 #include "SimTree.h"
-#include "Settings.h"
 #include "MbRandom.h"
+#include "ParameterSweep.h"
+#include "SampledTree.h"
+#include "Log.h"
 
 
-SimTreeEngine::SimTreeEngine(Settings* settings, MbRandom* random) :
-    _settings{settings},
+namespace {
+
+std::vector<const SimulationConfig*> addressesOf(const std::vector<SimulationConfig>& configs)
+{
+    std::vector<const SimulationConfig*> addresses;
+    for (int i = 0; i < (int)configs.size(); i++){
+        addresses.push_back(&configs[i]);
+    }
+    return addresses;
+}
+
+}
+
+
+SimTreeEngine::SimTreeEngine(const SimulationConfig* config, MbRandom* random,
+                             const Checkpoint* resumeFrom) :
+    SimTreeEngine(std::vector<const SimulationConfig*>(1, config), random, false, resumeFrom)
+{
+}
+
+
+SimTreeEngine::SimTreeEngine(const std::vector<SimulationConfig>& configs, MbRandom* random) :
+    SimTreeEngine(addressesOf(configs), random, true, nullptr)
+{
+}
+
+
+// Run-level settings (threads, output) come from the first configuration
+
+SimTreeEngine::SimTreeEngine(const std::vector<const SimulationConfig*>& configs,
+                             MbRandom* random, bool isSweep,
+                             const Checkpoint* resumeFrom) :
+    _config{configs[0]},
     _random{random},
+    _configs{configs},
+    _firstSim{},
+    _isSweep{isSweep},
     _numberOfSims{0},
+    _firstTree{0},
+    _endTree{0},
+    _numberOfThreads{1},
     _BADMAX{0},
-    _mintaxa{0},
-    _maxtaxa{0},
-    _minNumberOfShifts{0},
-    _maxNumberOfShifts{0},
-    _minTreeAge{0.0},
-    _treefile{},
-    _eventfile{},
-    _simtrees{}
+    _simtrees{},
+    _isStreaming{false},
+    _maxPendingTrees{0},
+    _nextToWrite{0},
+    _pendingTrees{},
+    _writeMutex{},
+    _treeWritten{},
+    _treeSink{},
+    _eventSink{},
+    _fossilTreeSink{},
+    _fossilEventSink{},
+    _extantTreeSink{},
+    _extantEventSink{},
+    _flushFreq{1},
+    _writer{},
+    _isArchive{false},
+    _archive{},
+    _openConfig{-1},
+    _isSamplingFossils{false},
+    _isRemappingFossilEvents{false},
+    _isSamplingExtant{false},
+    _isRemappingExtantEvents{false},
+    _isCheckpointing{false},
+    _checkpointFreq{1},
+    _checkpoint{*configs[0], random->getSeed()},
+    _console{&std::cout},
+    _nextSim{0},
+    _failed{false},
+    _metrics{},
+    _arenaStatistics{},
+    _arenaMutex{}
 
 {
-    _numberOfSims = _settings->get<int>("numberOfSims");
-    _treefile = _settings->get<std::string>("treefile");
-    _eventfile = _settings->get<std::string>("eventfile");
+    _firstSim.push_back(0);
+    for (int i = 0; i < (int)_configs.size(); i++){
+        _numberOfSims += _configs[i]->numberOfSims;
+        _firstSim.push_back(_numberOfSims);
+    }
+    
+    _endTree = _numberOfSims;
+    if (!_isSweep){
+        _firstTree = _config->getFirstSim();
+        _endTree = _config->getEndSim();
+    }
     
     _BADMAX = 2000;
     
-    _mintaxa = _settings->get<int>("mintaxa");
-    _maxtaxa = _settings->get<int>("maxtaxa");
-    _minNumberOfShifts = _settings->get<int>("minNumberOfShifts");
-    _maxNumberOfShifts = _settings->get<int>("maxNumberOfShifts");
-    _minTreeAge = _settings->get<double>("minTime");
+    _metrics.setOutput(_config->metricsfile, _config->metricsInterval);
+
+    _numberOfThreads = _config->threads;
+    _isArchive = (_config->outputFormat == ArchiveOutput);
+    _isSamplingFossils = _config->samplesFossils();
+    _isRemappingFossilEvents = _config->remapsFossilEvents();
+    _isSamplingExtant = _config->samplesExtant();
+    _isRemappingExtantEvents = _config->remapsExtantEvents();
+    
+    _isCheckpointing = _config->writesCheckpoints();
+    _checkpointFreq = _config->checkpointFreq;
+    if (resumeFrom != nullptr){
+        _firstTree = resumeFrom->acceptedTrees;
+    }
+    
+    // Standard output can only be written as the trees are accepted,
+    //   and a checkpoint can only record trees that are already written
+    _isStreaming = _config->streamOutput || _config->writesToStdout() || _isCheckpointing;
+    _maxPendingTrees = 4 * _numberOfThreads;
+    _flushFreq = _config->outputFlushFreq;
+    _writer.setPrecision(_config->outputPrecision);
+    
+    if (_config->writesToStdout()){
+        _console = &std::cerr;
+    }
+    
+    if (resumeFrom != nullptr){
+        *_console << "Resuming after tree " << _firstTree - 1 << "....\n";
+        resumeSinks(*resumeFrom);
+    }else{
+        openSinks(0);
+    }
+    
+    run();
+}
+
 
+void SimTreeEngine::run()
+{
+    *_console << "Simulating....\n";
     
-    for (int i = 0; i < _numberOfSims; i++){
-         _simtrees.push_back(getTreeInstance());
- 
-        //_simtrees[i]->recursiveCheckTime();
-        //_simtrees[i]->checkBranchLengths();
-        
-        std::cout << "tree " << i << " has << ";
-        std::cout << _simtrees[i]->getNumberOfTips() << " >> tips";
-        std::cout << "\tshifts: " << _simtrees[i]->getNumberOfShifts() << std::endl;
-        
+    simulateTrees();
+    
+    if (_failed){
+        printRejections();
+        _metrics.write(true);
+        *_console << "cannot simulate valid tree with params" << std::endl;
+        *_console << "MAXBAD exceeded" << std::endl;
+        exit(0);
+    }
+    
+    if (!_isStreaming){
+        for (int i = _firstTree; i < _endTree; i++){
+            
+            //_simtrees[i]->recursiveCheckTime();
+            //_simtrees[i]->checkBranchLengths();
+            
+            printTreeSummary(i, _simtrees[i]);
+        }
     }
     
+    printRejections();
+    printArenaStatistics();
+    
     // Data output
     
-    writeTrees();
-    writeEventData();
+    if (!_isStreaming){
+        writeTrees();
+    }
+    
+    _metrics.write(true);
+    
+    if (_isCheckpointing){
+        writeCheckpoint(true);
+    }
+    
+    closeSinks();
 }
 
 
@@ -70,30 +197,141 @@ SimTreeEngine::~SimTreeEngine()
 }
 
 
-SimTree* SimTreeEngine::getTreeInstance()
+// Spreads the tree indices over a pool of worker threads.
+// Each index draws all of its attempts from its own RNG stream
+//   (see MbRandom::getStream),
+//   so the accepted trees do not depend on the number of threads
+//   or on the order in which the workers finish.
+// In a sweep, sim r of every configuration uses stream r, so each
+//   configuration gives the same trees as a run of its own.
+
+void SimTreeEngine::simulateTrees()
 {
-    bool isBad = true;
-    int badctr = 0;
-    while (isBad){
-        SimTree* myTree = new SimTree(_random, _settings);
-        if (isTreeValid(myTree)){
-            return myTree;
+    _simtrees.assign(_numberOfSims, nullptr);
+    _nextSim = _firstTree;
+    _nextToWrite = _firstTree;
+    _failed = false;
+    
+    int nthreads = std::min(_numberOfThreads, _endTree - _firstTree);
+    if (nthreads <= 1){
+        runWorker();
+        return;
+    }
+    
+    std::vector<std::thread> workers;
+    for (int i = 0; i < nthreads; i++){
+        workers.push_back(std::thread(&SimTreeEngine::runWorker, this));
+    }
+    for (int i = 0; i < (int)workers.size(); i++){
+        workers[i].join();
+    }
+}
+
+
+// Each worker allocates its attempts from one arena, rewound after
+//   every rejection. An accepted tree keeps the arena it was built in,
+//   and the worker continues with a new one.
+
+void SimTreeEngine::runWorker()
+{
+    SimArena* arena = new SimArena;
+    
+    while (!_failed){
+        int i = _nextSim++;
+        if (i >= _endTree){
+            break;
+        }
+        
+        if (_isStreaming){
+            waitForWriteWindow(i);
+        }
+        
+        int c = getConfigIndex(i);
+        MbRandom random = _random->getStream(i - _firstSim[c]);
+        SimTree* tree = getTreeInstance(&random, arena, _configs[c]);
+        if (tree == nullptr){
+            // Under the lock, so that no worker misses the wakeup
+            std::lock_guard<std::mutex> lock(_writeMutex);
+            _failed = true;
+            _treeWritten.notify_all();
+            break;
+        }
+        
+        // Drawn from the rest of the tree's stream
+        if (_isSamplingFossils){
+            SampledTree* fossilTree = new SampledTree;
+            fossilTree->sampleFossils(tree->getTreeStore(), &random,
+                                      _configs[c]->psi, _configs[c]->rho);
+            if (_isRemappingFossilEvents){
+                fossilTree->remapEvents(tree);
+            }
+            tree->setFossilTree(fossilTree);
+        }
+        
+        // The extant species of the fossil sample, when there is one: both
+        //   draw them first, so they are the same species either way
+        if (_isSamplingExtant){
+            SampledTree* extantTree = new SampledTree;
+            if (_isSamplingFossils){
+                extantTree->keepExtant(*tree->getFossilTree());
+            }else{
+                extantTree->sampleFossils(tree->getTreeStore(), &random, 0.0, _configs[c]->rho);
+            }
+            if (_isRemappingExtantEvents){
+                extantTree->remapEvents(tree);
+            }
+            tree->setExtantTree(extantTree);
+        }
+        
+        addArenaStatistics(arena);
+        tree->adoptArena(arena);
+        arena = new SimArena;
+        
+        if (_isStreaming){
+            commitTree(i, tree);
         }else{
-            badctr++;
+            _simtrees[i] = tree;
         }
-        if (badctr > _BADMAX){
-            std::cout << "cannot simulate valid tree with params" << std::endl;
-            std::cout << "MAXBAD exceeded" << std::endl;
-            exit(0);
+    }
+    
+    addArenaStatistics(arena);
+    delete arena;
+}
+
+
+// Returns nullptr if no valid tree was found within _BADMAX attempts
+
+SimTree* SimTreeEngine::getTreeInstance(MbRandom* random, SimArena* arena,
+                                        const SimulationConfig* config)
+{
+    int badctr = 0;
+    while (badctr <= _BADMAX){
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        SimTree* myTree = new SimTree(random, config, arena);
+        bool isValid = isTreeValid(myTree, config);
+        int64_t nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>
+                (std::chrono::steady_clock::now() - start).count();
         
+        _metrics.addAttempt(isValid ? NotRejected : myTree->getRejectionReason(),
+                            myTree->getTreeStore()->size(), nanoseconds);
+        if (isValid){
+            _metrics.addTree(badctr + 1);
+            _metrics.writeIfDue();
+            myTree->getTreeStore()->computeSpanningTips();
+            return myTree;
         }
+        if (config->printRejectedAttempts){
+            printRejectedAttempt(badctr + 1, myTree);
+        }
+        delete myTree;
+        arena->reset();
+        badctr++;
     }
-    std::cout << "Should not get here, terminating" << std::endl;
-    exit(1);
+    return nullptr;
 }
 
 
-bool SimTreeEngine::isTreeValid(SimTree* x)
+bool SimTreeEngine::isTreeValid(SimTree* x, const SimulationConfig* config)
 {
     if (x->getIsTreeBad()){
         return false;
@@ -102,74 +340,328 @@ bool SimTreeEngine::isTreeValid(SimTree* x)
     int tips = x->getNumberOfTips();
     int shifts = x->getNumberOfShifts();
     double age = x->getTreeAge();
-        
-    bool isGood = (tips >= _mintaxa && tips <= _maxtaxa
-                   && shifts >= _minNumberOfShifts && shifts <= _maxNumberOfShifts
-                   && age >= _minTreeAge);
-        
-    return isGood;
+    
+    if (tips > config->maxtaxa){
+        x->setRejectionReason(TooManyTips);
+    }else if (tips < config->mintaxa){
+        x->setRejectionReason(TooFewTips);
+    }else if (shifts > config->maxNumberOfShifts){
+        x->setRejectionReason(TooManyShifts);
+    }else if (shifts < config->minNumberOfShifts){
+        x->setRejectionReason(TooFewShifts);
+    }else if (age < config->minTime){
+        x->setRejectionReason(TooYoung);
+    }else{
+        return true;
+    }
+    
+    return false;
 }
 
 
+int SimTreeEngine::getConfigIndex(int index) const
+{
+    return (int)(std::upper_bound(_firstSim.begin(), _firstSim.end(), index)
+                 - _firstSim.begin()) - 1;
+}
 
-void SimTreeEngine::writeTrees()
+
+// Opens the output files (or stdout) and writes the event file header.
+// In a sweep every configuration has files of its own.
+
+void SimTreeEngine::openSinks(int configIndex)
 {
-    std::string outname = _treefile;
-    std::ofstream outStream;
-    outStream.open(outname.c_str());
-    outStream.close();
+    std::string treefile = _config->treefile;
+    std::string eventfile = _config->eventfile;
+    std::string archivefile = _config->archivefile;
+    std::string fossiltreefile = _config->fossiltreefile;
+    std::string fossileventfile = _config->fossileventfile;
+    std::string extanttreefile = _config->extanttreefile;
+    std::string extanteventfile = _config->extanteventfile;
+    if (_isSweep){
+        treefile = ParameterSweep::configFileName(treefile, configIndex + 1);
+        eventfile = ParameterSweep::configFileName(eventfile, configIndex + 1);
+        archivefile = ParameterSweep::configFileName(archivefile, configIndex + 1);
+        fossiltreefile = ParameterSweep::configFileName(fossiltreefile, configIndex + 1);
+        fossileventfile = ParameterSweep::configFileName(fossileventfile, configIndex + 1);
+        extanttreefile = ParameterSweep::configFileName(extanttreefile, configIndex + 1);
+        extanteventfile = ParameterSweep::configFileName(extanteventfile, configIndex + 1);
+    }
+    _openConfig = configIndex;
     
-    for (int i = 0; i < (int)_simtrees.size(); i++){
-        std::ofstream tmpstream;
-        tmpstream.open(outname.c_str(), std::ofstream::out | std::ofstream::app);
-        
-        std::stringstream ss;
-        _simtrees[i]->writeTree(_simtrees[i]->getRoot(), ss);
-        ss << ";";
-        
-        tmpstream << ss.str() << std::endl;
-        
-        tmpstream.close();
+    if (_isSamplingFossils &&
+            !_fossilTreeSink.open(fossiltreefile, _config->fossilTreeCompression)){
+        exit(1);
+    }
+    if (_isRemappingFossilEvents){
+        if (!_fossilEventSink.open(fossileventfile, _config->fossilEventCompression)){
+            exit(1);
+        }
+        _fossilEventSink.write("sim,leftchild,rightchild,abstime,lambdainit,lambdashift,muinit\n");
+    }
+    if (_isSamplingExtant &&
+            !_extantTreeSink.open(extanttreefile, _config->extantTreeCompression)){
+        exit(1);
+    }
+    if (_isRemappingExtantEvents){
+        if (!_extantEventSink.open(extanteventfile, _config->extantEventCompression)){
+            exit(1);
+        }
+        _extantEventSink.write("sim,leftchild,rightchild,abstime,lambdainit,lambdashift,muinit\n");
+    }
+    
+    if (_isArchive){
+        if (!_archive.open(archivefile)){
+            exit(1);
+        }
+        return;
+    }
+    
+    if (!_treeSink.open(treefile, _config->treeCompression) ||
+        !_eventSink.open(eventfile, _config->eventCompression)){
+        exit(1);
     }
     
+    _eventSink.write("sim,leftchild,rightchild,abstime,lambdainit,lambdashift,muinit\n");
 }
 
 
-void SimTreeEngine::writeEventData()
+// Continues the files of a checkpointed run from where its checkpoint
+//   left them; anything written after the checkpoint is cut off
+
+void SimTreeEngine::resumeSinks(const Checkpoint& checkpoint)
 {
-    std::string outname = _eventfile;
-    std::ofstream outStream;
-    outStream.open(outname.c_str());
-    // Write header:
-    outStream << "sim,leftchild,rightchild,abstime,lambdainit,lambdashift,muinit\n";
-    outStream.close();
+    _openConfig = 0;
     
-    for (int i = 0; i < (int)_simtrees.size(); i++){
-        std::ofstream tmpstream;
-        tmpstream.open(outname.c_str(), std::ofstream::out | std::ofstream::app);
-        _simtrees[i]->getEventDataString(i+1, tmpstream);
+    if (_isSamplingFossils &&
+            !_fossilTreeSink.resume(_config->fossiltreefile, checkpoint.fossiltreefileBytes)){
+        exit(1);
+    }
+    if (_isRemappingFossilEvents &&
+            !_fossilEventSink.resume(_config->fossileventfile, checkpoint.fossileventfileBytes)){
+        exit(1);
+    }
+    if (_isSamplingExtant &&
+            !_extantTreeSink.resume(_config->extanttreefile, checkpoint.extanttreefileBytes)){
+        exit(1);
+    }
+    if (_isRemappingExtantEvents &&
+            !_extantEventSink.resume(_config->extanteventfile, checkpoint.extanteventfileBytes)){
+        exit(1);
+    }
     
-        tmpstream.close();
+    if (_isArchive){
+        if (!_archive.resume(_config->archivefile, checkpoint.archivefileBytes)){
+            exit(1);
+        }
+        if (_archive.getNumberOfTrees() != (uint64_t)checkpoint.acceptedTrees){
+            log(Error) << "Tree archive <<" << _config->archivefile
+                       << ">> does not match the checkpoint.\n";
+            exit(1);
+        }
+        return;
     }
     
+    if (!_treeSink.resume(_config->treefile, checkpoint.treefileBytes) ||
+        !_eventSink.resume(_config->eventfile, checkpoint.eventfileBytes)){
+        exit(1);
+    }
+}
+
+
+// Syncs the trees written so far to disk, then records them; called with
+//   _writeMutex held, or after the workers have finished
+
+void SimTreeEngine::writeCheckpoint(bool isFinished)
+{
+    _treeSink.checkpoint();
+    _eventSink.checkpoint();
+    _archive.checkpoint();
+    _fossilTreeSink.checkpoint();
+    _fossilEventSink.checkpoint();
+    _extantTreeSink.checkpoint();
+    _extantEventSink.checkpoint();
     
+    _checkpoint.acceptedTrees = _nextToWrite;
+    _checkpoint.isFinished = isFinished;
+    _checkpoint.treefileBytes = _treeSink.getBytesWritten();
+    _checkpoint.eventfileBytes = _eventSink.getBytesWritten();
+    _checkpoint.archivefileBytes = _archive.getBytesWritten();
+    _checkpoint.fossiltreefileBytes = _fossilTreeSink.getBytesWritten();
+    _checkpoint.fossileventfileBytes = _fossilEventSink.getBytesWritten();
+    _checkpoint.extanttreefileBytes = _extantTreeSink.getBytesWritten();
+    _checkpoint.extanteventfileBytes = _extantEventSink.getBytesWritten();
+    _checkpoint.write(_config->checkpointfile);
+}
+
+
+// Writes out everything still buffered and syncs the files to disk
+
+void SimTreeEngine::closeSinks()
+{
+    _treeSink.close();
+    _eventSink.close();
+    _archive.close();
+    _fossilTreeSink.close();
+    _fossilEventSink.close();
+    _extantTreeSink.close();
+    _extantEventSink.close();
+}
+
+
+// Keeps a worker from running more than _maxPendingTrees ahead of the
+//   output, so that the trees waiting to be written stay bounded
+
+void SimTreeEngine::waitForWriteWindow(int index)
+{
+    std::unique_lock<std::mutex> lock(_writeMutex);
+    while (index >= _nextToWrite + _maxPendingTrees && !_failed){
+        _treeWritten.wait(lock);
+    }
+}
+
+
+// Writes and frees every finished tree that is next in line
+
+void SimTreeEngine::commitTree(int index, SimTree* tree)
+{
+    std::lock_guard<std::mutex> lock(_writeMutex);
+    _pendingTrees[index] = tree;
     
+    while (!_pendingTrees.empty() && _pendingTrees.begin()->first == _nextToWrite){
+        SimTree* next = _pendingTrees.begin()->second;
+        _pendingTrees.erase(_pendingTrees.begin());
+        
+        printTreeSummary(_nextToWrite, next);
+        writeTree(_nextToWrite, next);
+        delete next;
+        
+        _nextToWrite++;
+        
+        if (_nextToWrite % _flushFreq == 0){
+            _treeSink.flush();
+            _eventSink.flush();
+            _archive.flush();
+            _fossilTreeSink.flush();
+            _fossilEventSink.flush();
+            _extantTreeSink.flush();
+            _extantEventSink.flush();
+        }
+        if (_isCheckpointing && _nextToWrite % _checkpointFreq == 0){
+            writeCheckpoint(false);
+        }
+    }
     
+    _treeWritten.notify_all();
 }
 
 
+// Output of one tree; trees are written in index order, so each
+//   configuration's files are finished before the next ones are opened
 
+void SimTreeEngine::writeTree(int index, SimTree* tree)
+{
+    int c = getConfigIndex(index);
+    if (c != _openConfig){
+        closeSinks();
+        openSinks(c);
+    }
+    index -= _firstSim[c];
+    
+    if (_isSamplingFossils){
+        _writer.clear();
+        _writer.writeNewick(tree->getFossilTree());
+        _fossilTreeSink.write(_writer.data(), _writer.size());
+    }
+    if (_isRemappingFossilEvents){
+        _writer.clear();
+        _writer.writeEventData(index + 1, tree->getFossilTree());
+        _fossilEventSink.write(_writer.data(), _writer.size());
+    }
+    if (_isSamplingExtant){
+        _writer.clear();
+        _writer.writeNewick(tree->getExtantTree());
+        _extantTreeSink.write(_writer.data(), _writer.size());
+    }
+    if (_isRemappingExtantEvents){
+        _writer.clear();
+        _writer.writeEventData(index + 1, tree->getExtantTree());
+        _extantEventSink.write(_writer.data(), _writer.size());
+    }
+    
+    if (_isArchive){
+        _archive.writeTree(tree);
+        return;
+    }
+    
+    _writer.clear();
+    _writer.writeNewick(tree);
+    _treeSink.write(_writer.data(), _writer.size());
+    
+    _writer.clear();
+    _writer.writeEventData(index + 1, tree);
+    _eventSink.write(_writer.data(), _writer.size());
+}
 
 
+void SimTreeEngine::printTreeSummary(int index, SimTree* tree)
+{
+    if (_isSweep){
+        int c = getConfigIndex(index);
+        *_console << "config " << c + 1 << " ";
+        index -= _firstSim[c];
+    }
+    *_console << "tree " << index << " has << ";
+    *_console << tree->getNumberOfTips() << " >> tips";
+    *_console << "\tshifts: " << tree->getNumberOfShifts() << std::endl;
+}
 
 
+void SimTreeEngine::addArenaStatistics(SimArena* arena)
+{
+    std::lock_guard<std::mutex> lock(_arenaMutex);
+    _arenaStatistics.add(arena->getStatistics());
+}
 
 
+void SimTreeEngine::printArenaStatistics()
+{
+    const ArenaStatistics& x = _arenaStatistics;
+    *_console << "arena allocations: " << x.objects << " objects";
+    *_console << "  " << x.bytes << " bytes";
+    *_console << "  " << x.blocks << " blocks";
+    *_console << "  " << x.resets << " resets";
+    *_console << "  peak " << x.peakBytes << " bytes per attempt" << std::endl;
+}
 
 
+// Only used to replay a single sim, so the attempts are printed in order
 
+void SimTreeEngine::printRejectedAttempt(int attempt, SimTree* tree)
+{
+    *_console << "attempt " << attempt << " rejected: ";
+    *_console << rejectionReasonName(tree->getRejectionReason());
+    *_console << "\ttips: " << tree->getNumberOfTips();
+    *_console << "\tshifts: " << tree->getNumberOfShifts();
+    *_console << "\tnodes: " << tree->getTreeStore()->size() << std::endl;
+}
 
 
+void SimTreeEngine::printRejections()
+{
+    *_console << "rejected attempts:";
+    for (int i = 1; i < NumberOfRejectionReasons; i++){
+        *_console << "  " << rejectionReasonName((RejectionReason)i);
+        *_console << " " << _metrics.getRejections((RejectionReason)i);
+    }
+    *_console << std::endl;
+}
 
 
 
+void SimTreeEngine::writeTrees()
+{
+    for (int i = _firstTree; i < _endTree; i++){
+        writeTree(i, _simtrees[i]);
+    }
+}
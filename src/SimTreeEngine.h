@@ -13,43 +13,139 @@
 #include <sstream>
 #include <fstream>
 #include <vector>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <map>
+
+#include "SimTree.h"
+#include "SimArena.h"
+#include "OutputSink.h"
+#include "TreeWriter.h"
+#include "TreeArchive.h"
+#include "SimulationConfig.h"
+#include "RunMetrics.h"
+#include "Checkpoint.h"
 
 class SimTree;
 class MbRandom;
-class Settings;
 
 class SimTreeEngine
 {
     
 private:
-    Settings* _settings;
+    const SimulationConfig* _config;    // settings of the run as a whole
     MbRandom* _random;
     
-    int _numberOfSims;
-    int _BADMAX;
-    int _mintaxa;
-    int _maxtaxa;
-    int _minNumberOfShifts;
-    int _maxNumberOfShifts;
-    double _minTreeAge;
+    // Configurations simulated, one after the other in index order:
+    //   sims _firstSim[c] to _firstSim[c + 1] - 1 belong to configuration c
+    std::vector<const SimulationConfig*> _configs;
+    std::vector<int> _firstSim;
+    bool _isSweep;
     
-    std::string _treefile;
-    std::string _eventfile;
+    int _numberOfSims;      // over all configurations
+    
+    // This process simulates sims _firstTree to _endTree - 1: a shard of
+    //   the run, or what is left of it after a checkpoint
+    int _firstTree;
+    int _endTree;
+    int _numberOfThreads;
+    int _BADMAX;
     
     std::vector<SimTree*> _simtrees;
+    
+    // Streaming output: each tree is written, in order of its index,
+    //   and freed as soon as it and all the trees before it are done.
+    //   A file name of "-" writes to standard output.
+    bool _isStreaming;
+    int  _maxPendingTrees;
+    int  _nextToWrite;
+    std::map<int, SimTree*> _pendingTrees;
+    std::mutex _writeMutex;
+    std::condition_variable _treeWritten;
+    
+    // Every output path writes through these; they stay open for the run
+    OutputSink _treeSink;
+    OutputSink _eventSink;
+    OutputSink _fossilTreeSink;
+    OutputSink _fossilEventSink;
+    OutputSink _extantTreeSink;
+    OutputSink _extantEventSink;
+    int _flushFreq;     // trees between flushes in streaming mode
+    
+    TreeWriter _writer;
+    
+    // outputFormat = archive writes a binary archive instead of text files
+    bool _isArchive;
+    TreeArchiveWriter _archive;
+    
+    int _openConfig;    // configuration whose files are open
+    
+    // Fossil sampling of each accepted tree, written alongside it,
+    //   with its shifts if _isRemappingFossilEvents
+    bool _isSamplingFossils;
+    bool _isRemappingFossilEvents;
+    
+    // Reconstructed tree of the sampled extant species, likewise
+    bool _isSamplingExtant;
+    bool _isRemappingExtantEvents;
+    
+    // Checkpoints every _checkpointFreq trees
+    bool _isCheckpointing;
+    int  _checkpointFreq;
+    Checkpoint _checkpoint;
+    
+    // Progress messages go to stderr when an output goes to stdout
+    std::ostream* _console;
 
+    // Shared by the worker threads
+    std::atomic<int>  _nextSim;
+    std::atomic<bool> _failed;
+    
+    // Attempt counts, costs and rejection reasons
+    RunMetrics _metrics;
+    
+    // Allocations of all the arenas used by the workers
+    ArenaStatistics _arenaStatistics;
+    std::mutex _arenaMutex;
+
+    SimTreeEngine(const std::vector<const SimulationConfig*>& configs,
+                  MbRandom* random, bool isSweep, const Checkpoint* resumeFrom);
+    
+    void run();
+    void simulateTrees();
+    void runWorker();
+    void printRejections();
+    void printRejectedAttempt(int attempt, SimTree* tree);
+    void printTreeSummary(int index, SimTree* tree);
+    
+    int getConfigIndex(int index) const;
+    void openSinks(int configIndex);
+    void resumeSinks(const Checkpoint& checkpoint);
+    void writeCheckpoint(bool isFinished);
+    void closeSinks();
+    void waitForWriteWindow(int index);
+    void commitTree(int index, SimTree* tree);
+    void writeTree(int index, SimTree* tree);
+    void addArenaStatistics(SimArena* arena);
+    void printArenaStatistics();
     
 public:
-    SimTreeEngine(Settings* settings, MbRandom* random);
+    // Continues the run of resumeFrom if it is not nullptr
+    SimTreeEngine(const SimulationConfig* config, MbRandom* random,
+                  const Checkpoint* resumeFrom = nullptr);
+    
+    // Parameter sweep: outputs are tagged with the configuration number
+    SimTreeEngine(const std::vector<SimulationConfig>& configs, MbRandom* random);
     SimTreeEngine(const SimTreeEngine&) = delete;
     SimTreeEngine& operator=(const SimTreeEngine&) = delete;
     ~SimTreeEngine();
     
-    SimTree* getTreeInstance(void);
-    bool isTreeValid(SimTree* x);
+    SimTree* getTreeInstance(MbRandom* random, SimArena* arena,
+                             const SimulationConfig* config);
+    static bool isTreeValid(SimTree* x, const SimulationConfig* config);
 
     void writeTrees();
-    void writeEventData();
 
 
 };
@@ -0,0 +1,420 @@
+//
+//  SimulationConfig.cpp
+//  simBAMM
+//
+
+#include "SimulationConfig.h"
+#include "Settings.h"
+#include "Log.h"
+
+#include <cstdlib>
+#include <sstream>
+#include <thread>
+
+
+namespace {
+
+void exitWithInvalidSetting(const std::string& message)
+{
+    log(Error) << message << "\n";
+    std::exit(1);
+}
+
+
+// compression = auto gzips the files whose names end in .gz
+
+OutputCompression parseCompression(const std::string& compression, const std::string& path)
+{
+    if (compression == "gzip"){
+        return GzipCompression;
+    }else if (compression == "auto"){
+        return OutputSink::hasGzipExtension(path) ? GzipCompression : NoCompression;
+    }else if (compression != "none"){
+        exitWithInvalidSetting("Unknown compression <<" + compression + ">>.\n"
+                               "Fix by setting compression to auto, gzip or none.");
+    }
+    return NoCompression;
+}
+
+
+// A shard or a single replayed sim writes files of its own
+
+void tagOutputFiles(SimulationConfig& c, const std::string& tag)
+{
+    const std::string none = "none";
+    for (std::string* path : {&c.treefile, &c.eventfile, &c.archivefile,
+                              &c.fossiltreefile, &c.fossileventfile,
+                              &c.extanttreefile, &c.extanteventfile,
+                              &c.metricsfile, &c.checkpointfile}){
+        if (*path != "-" && *path != none){
+            *path = taggedFileName(*path, tag);
+        }
+    }
+}
+
+
+void validate(const SimulationConfig& c)
+{
+    if (c.numberOfSims < 1){
+        exitWithInvalidSetting("numberOfSims must be at least 1.");
+    }
+    if (c.shardCount < 1 || c.shardIndex < 1 || c.shardIndex > c.shardCount){
+        exitWithInvalidSetting("shard k/N must satisfy 1 <= k <= N.");
+    }
+    if (c.shardCount > 1 && c.seed == -1){
+        exitWithInvalidSetting("The shards of a run must share its seed.\n"
+                               "Fix by setting seed to the same value for every shard.");
+    }
+    if (c.onlySim < 0 || c.onlySim > c.numberOfSims){
+        exitWithInvalidSetting("onlySim must be between 1 and numberOfSims (0: every sim).");
+    }
+    if (c.onlySim != 0 && (c.shardCount > 1 || c.writesCheckpoints())){
+        exitWithInvalidSetting("A single sim (onlySim) cannot be sharded or checkpointed.");
+    }
+    if (c.printRejectedAttempts && c.onlySim == 0){
+        exitWithInvalidSetting("printRejectedAttempts applies to a single sim; set onlySim too.");
+    }
+    if (c.maxTime <= 0.0){
+        exitWithInvalidSetting("maxTime must be positive.");
+    }
+    if (c.eventRate < 0.0){
+        exitWithInvalidSetting("eventRate cannot be negative.");
+    }
+    if (c.simulationEngine == DiscreteEngine && c.inc <= 0.0){
+        exitWithInvalidSetting("inc must be positive.");
+    }
+    if (c.maxNumberOfNodes < 1){
+        exitWithInvalidSetting("maxNumberOfNodes must be at least 1.");
+    }
+    
+#ifdef SAMPLE_EXPONENTIAL
+    if (c.lambdaExpMean <= 0.0){
+        exitWithInvalidSetting("lambdaExpMean must be set to a positive value.");
+    }
+    if (c.muExpMean < 0.0){
+        exitWithInvalidSetting("muExpMean must be set to a value of 0 or more.");
+    }
+#else
+    if (c.rmin <= 0.0 || c.rmax < c.rmin){
+        exitWithInvalidSetting("rmin and rmax must satisfy 0 < rmin <= rmax.");
+    }
+    if (c.epsmin < 0.0 || c.epsmax < c.epsmin || c.epsmax >= 1.0){
+        exitWithInvalidSetting("epsmin and epsmax must satisfy 0 <= epsmin <= epsmax < 1.");
+    }
+#endif
+    
+    if (c.maxtaxa < 1 || c.mintaxa > c.maxtaxa){
+        exitWithInvalidSetting("mintaxa and maxtaxa must satisfy mintaxa <= maxtaxa, maxtaxa >= 1.");
+    }
+    if (c.maxNumberOfShifts < 0 || c.minNumberOfShifts > c.maxNumberOfShifts){
+        exitWithInvalidSetting("minNumberOfShifts and maxNumberOfShifts must satisfy "
+                               "minNumberOfShifts <= maxNumberOfShifts, maxNumberOfShifts >= 0.");
+    }
+    
+    if (c.outputFormat == TextOutput && c.treefile == "-" && c.eventfile == "-"){
+        exitWithInvalidSetting("treefile and eventfile cannot both be written to stdout.");
+    }
+    if (c.psi < 0.0){
+        exitWithInvalidSetting("psi cannot be negative.");
+    }
+    if (c.rho < 0.0 || c.rho > 1.0){
+        exitWithInvalidSetting("rho must be between 0 and 1.");
+    }
+    for (const std::string* path : {&c.fossiltreefile, &c.fossileventfile,
+                                    &c.extanttreefile, &c.extanteventfile}){
+        if (*path == "-"){
+            exitWithInvalidSetting("Only treefile and eventfile can be written to stdout.");
+        }
+    }
+    if (c.remapsFossilEvents() && !c.samplesFossils()){
+        exitWithInvalidSetting("fossileventfile needs a fossiltreefile for its trees.");
+    }
+    if (c.remapsExtantEvents() && !c.samplesExtant()){
+        exitWithInvalidSetting("extanteventfile needs an extanttreefile for its trees.");
+    }
+    if (c.outputFlushFreq < 1){
+        exitWithInvalidSetting("outputFlushFreq must be at least 1.");
+    }
+    if (c.outputPrecision < 0 || c.outputPrecision > 17){
+        exitWithInvalidSetting("outputPrecision must be between 0 and 17.");
+    }
+    if (c.metricsInterval < 0.0){
+        exitWithInvalidSetting("metricsInterval cannot be negative.");
+    }
+    
+    if (c.resume && !c.writesCheckpoints()){
+        exitWithInvalidSetting("resume needs the checkpointfile of the run to resume.");
+    }
+    if (c.writesCheckpoints()){
+        if (c.checkpointFreq < 1){
+            exitWithInvalidSetting("checkpointFreq must be at least 1.");
+        }
+        if (c.writesToStdout()){
+            exitWithInvalidSetting("A run written to stdout cannot be checkpointed.");
+        }
+        // A gzip stream cannot be cut at a checkpoint and continued
+        if ((c.outputFormat == TextOutput &&
+                (c.treeCompression != NoCompression || c.eventCompression != NoCompression)) ||
+                (c.samplesFossils() && c.fossilTreeCompression != NoCompression) ||
+                (c.remapsFossilEvents() && c.fossilEventCompression != NoCompression) ||
+                (c.samplesExtant() && c.extantTreeCompression != NoCompression) ||
+                (c.remapsExtantEvents() && c.extantEventCompression != NoCompression)){
+            exitWithInvalidSetting("A run with compressed output cannot be checkpointed.\n"
+                                   "Fix by compressing the files once the run is done.");
+        }
+    }
+}
+
+}
+
+
+SimulationConfig::SimulationConfig() :
+    numberOfSims{0},
+    threads{1},
+    shardIndex{1},
+    shardCount{1},
+    onlySim{0},
+    printRejectedAttempts{false},
+    seed{-1},
+    rngEngine{PhiloxEngine},
+    simulationEngine{DiscreteEngine},
+    eventRate{0.0},
+    maxTime{0.0},
+    maxTimeForEvent{0.0},
+    inc{0.0},
+    maxNumberOfNodes{0},
+    lambdaInit0{-1.0},
+    lambdaShift0{-1.0},
+    muInit0{-1.0},
+    lambdaExpMean{-1.0},
+    muExpMean{-1.0},
+    rmin{-1.0},
+    rmax{-1.0},
+    epsmin{0.0},
+    epsmax{1.0},
+    rInitLogscale{false},
+    mintaxa{0},
+    maxtaxa{0},
+    minNumberOfShifts{0},
+    maxNumberOfShifts{0},
+    minTime{0.0},
+    psi{0.0},
+    rho{1.0},
+    treefile{},
+    eventfile{},
+    archivefile{},
+    fossiltreefile{"none"},
+    fossileventfile{"none"},
+    extanttreefile{"none"},
+    extanteventfile{"none"},
+    outputFormat{TextOutput},
+    treeCompression{NoCompression},
+    eventCompression{NoCompression},
+    fossilTreeCompression{NoCompression},
+    fossilEventCompression{NoCompression},
+    extantTreeCompression{NoCompression},
+    extantEventCompression{NoCompression},
+    streamOutput{false},
+    outputFlushFreq{100},
+    outputPrecision{6},
+    metricsfile{"none"},
+    metricsInterval{0.0},
+    checkpointfile{"none"},
+    checkpointFreq{1000},
+    resume{false}
+{
+}
+
+
+SimulationConfig::SimulationConfig(const Settings& settings) :
+    SimulationConfig()
+{
+    numberOfSims = settings.get<int>("numberOfSims");
+    seed = settings.get<long int>("seed");
+    
+    threads = settings.get<int>("threads");
+    if (threads <= 0){
+        threads = (int)std::thread::hardware_concurrency();
+        if (threads <= 0){
+            threads = 1;
+        }
+    }
+    
+    // shard = k/N; every file of shard k is tagged _s<k>
+    std::string shard = settings.get("shard");
+    if (shard != "none"){
+        char slash = 0;
+        std::istringstream in(shard);
+        if (!(in >> shardIndex >> slash >> shardCount) || slash != '/' || !in.eof()){
+            exitWithInvalidSetting("Cannot read shard <<" + shard + ">>.\n"
+                                   "Fix by setting shard to k/N, as in 3/8.");
+        }
+    }
+    
+    onlySim = settings.get<int>("onlySim");
+    printRejectedAttempts = settings.get<bool>("printRejectedAttempts");
+    
+    std::string engineName = settings.get("rngEngine");
+    if (engineName == "lcg"){
+        rngEngine = LcgEngine;
+    }else if (engineName != "philox"){
+        exitWithInvalidSetting("Unknown rngEngine <<" + engineName + ">>.\n"
+                               "Fix by setting rngEngine to philox or lcg.");
+    }
+    
+    std::string simulationEngineName = settings.get("simulationEngine");
+    if (simulationEngineName == "exact"){
+        simulationEngine = ExactEngine;
+    }else if (simulationEngineName != "discrete"){
+        exitWithInvalidSetting("Unknown simulationEngine <<" + simulationEngineName + ">>.\n"
+                               "Fix by setting simulationEngine to discrete or exact.");
+    }
+    
+    eventRate = settings.get<double>("eventRate");
+    maxTime = settings.get<double>("maxTime");
+    maxTimeForEvent = settings.get<double>("maxTimeForEvent");
+    if (maxTimeForEvent <= 0.0){
+        maxTimeForEvent = maxTime;
+    }
+    inc = settings.get<double>("inc");
+    maxNumberOfNodes = settings.get<int>("maxNumberOfNodes");
+    
+    lambdaInit0 = settings.get<double>("lambdaInit0");
+    lambdaShift0 = settings.get<double>("lambdaShift0");
+    muInit0 = settings.get<double>("muInit0");
+    lambdaExpMean = settings.get<double>("lambdaExpMean");
+    muExpMean = settings.get<double>("muExpMean");
+    rmin = settings.get<double>("rmin");
+    rmax = settings.get<double>("rmax");
+    epsmin = settings.get<double>("epsmin");
+    epsmax = settings.get<double>("epsmax");
+    rInitLogscale = settings.get<bool>("rInitLogscale");
+    
+    mintaxa = settings.get<int>("mintaxa");
+    maxtaxa = settings.get<int>("maxtaxa");
+    minNumberOfShifts = settings.get<int>("minNumberOfShifts");
+    maxNumberOfShifts = settings.get<int>("maxNumberOfShifts");
+    minTime = settings.get<double>("minTime");
+    
+    psi = settings.get<double>("psi");
+    rho = settings.get<double>("rho");
+    
+    treefile = settings.get("treefile");
+    eventfile = settings.get("eventfile");
+    archivefile = settings.get("archivefile");
+    fossiltreefile = settings.get("fossiltreefile");
+    fossileventfile = settings.get("fossileventfile");
+    extanttreefile = settings.get("extanttreefile");
+    extanteventfile = settings.get("extanteventfile");
+    
+    std::string formatName = settings.get("outputFormat");
+    if (formatName == "archive"){
+        outputFormat = ArchiveOutput;
+    }else if (formatName != "text"){
+        exitWithInvalidSetting("Unknown outputFormat <<" + formatName + ">>.\n"
+                               "Fix by setting outputFormat to text or archive.");
+    }
+    
+    std::string compression = settings.get("compression");
+    treeCompression = parseCompression(compression, treefile);
+    eventCompression = parseCompression(compression, eventfile);
+    fossilTreeCompression = parseCompression(compression, fossiltreefile);
+    fossilEventCompression = parseCompression(compression, fossileventfile);
+    extantTreeCompression = parseCompression(compression, extanttreefile);
+    extantEventCompression = parseCompression(compression, extanteventfile);
+    
+    streamOutput = settings.get<bool>("streamOutput");
+    outputFlushFreq = settings.get<int>("outputFlushFreq");
+    outputPrecision = settings.get<int>("outputPrecision");
+    metricsfile = settings.get("metricsfile");
+    metricsInterval = settings.get<double>("metricsInterval");
+    checkpointfile = settings.get("checkpointfile");
+    checkpointFreq = settings.get<int>("checkpointFreq");
+    resume = settings.get<bool>("resume");
+    
+    validate(*this);
+    
+    if (shardCount > 1){
+        tagOutputFiles(*this, "_s" + std::to_string(shardIndex));
+    }
+    if (onlySim != 0){
+        tagOutputFiles(*this, "_sim" + std::to_string(onlySim));
+    }
+}
+
+
+bool SimulationConfig::writesToStdout() const
+{
+    return outputFormat == TextOutput && (treefile == "-" || eventfile == "-");
+}
+
+
+bool SimulationConfig::writesCheckpoints() const
+{
+    return checkpointfile != "none";
+}
+
+
+int SimulationConfig::getFirstSim() const
+{
+    if (onlySim != 0){
+        return onlySim - 1;
+    }
+    return (int)((long long)numberOfSims * (shardIndex - 1) / shardCount);
+}
+
+
+int SimulationConfig::getEndSim() const
+{
+    if (onlySim != 0){
+        return onlySim;
+    }
+    return (int)((long long)numberOfSims * shardIndex / shardCount);
+}
+
+
+// The tag goes before the extension (and before .gz):
+//   simtrees.txt -> simtrees_s3.txt, simtrees.txt.gz -> simtrees_s3.txt.gz
+
+std::string taggedFileName(const std::string& path, const std::string& tag)
+{
+    std::string stem = path;
+    std::string extension;
+    if (OutputSink::hasGzipExtension(stem)){
+        extension = ".gz";
+        stem.erase(stem.size() - 3);
+    }
+    
+    std::size_t slash = stem.find_last_of("/\\");
+    std::size_t dot = stem.find_last_of('.');
+    if (dot != std::string::npos && (slash == std::string::npos || dot > slash)){
+        extension = stem.substr(dot) + extension;
+        stem.erase(dot);
+    }
+    
+    return stem + tag + extension;
+}
+
+
+bool SimulationConfig::samplesFossils() const
+{
+    return fossiltreefile != "none";
+}
+
+
+bool SimulationConfig::remapsFossilEvents() const
+{
+    return fossileventfile != "none";
+}
+
+
+bool SimulationConfig::samplesExtant() const
+{
+    return extanttreefile != "none";
+}
+
+
+bool SimulationConfig::remapsExtantEvents() const
+{
+    return extanteventfile != "none";
+}
@@ -0,0 +1,131 @@
+//
+//  SimulationConfig.h
+//  simBAMM
+//
+
+#ifndef __simBAMM__SimulationConfig__
+#define __simBAMM__SimulationConfig__
+
+#include <string>
+
+#include "MbRandom.h"
+#include "OutputSink.h"
+
+class Settings;
+
+
+// Draw the rates of the root and of every new regime from exponential
+//   distributions with means lambdaExpMean and muExpMean (otherwise from
+//   the r/eps ranges)
+#define SAMPLE_EXPONENTIAL
+
+
+enum SimulationEngineType {
+    DiscreteEngine,
+    ExactEngine
+};
+
+enum OutputFormat {
+    TextOutput,
+    ArchiveOutput
+};
+
+
+// Settings of a run, parsed once and checked before anything is simulated.
+// Trees and the engine read their parameters from here rather than from
+//   Settings, so no strings are looked up or parsed while simulating.
+
+struct SimulationConfig
+{
+    // Run
+    int numberOfSims;
+    int threads;                    // resolved: never <= 0
+    int shardIndex;                 // this process simulates shard
+    int shardCount;                 //   shardIndex (1 to shardCount)
+    int onlySim;                    // replays this sim alone (from 1); 0: every sim
+    bool printRejectedAttempts;     //   and prints the attempts rejected before it
+    long int seed;
+    RandomEngineType rngEngine;
+    SimulationEngineType simulationEngine;
+
+    // Birth-death-shift process
+    double eventRate;
+    double maxTime;
+    double maxTimeForEvent;         // resolved: maxTime if not set
+    double inc;
+    int maxNumberOfNodes;
+
+    double lambdaInit0;
+    double lambdaShift0;
+    double muInit0;
+    double lambdaExpMean;
+    double muExpMean;
+    double rmin;
+    double rmax;
+    double epsmin;
+    double epsmax;
+    bool rInitLogscale;
+
+    // Acceptance
+    int mintaxa;
+    int maxtaxa;
+    int minNumberOfShifts;
+    int maxNumberOfShifts;
+    double minTime;
+    
+    // Fossil and extant sampling of accepted trees (see SampledTree)
+    double psi;                     // fossils per unit branch length
+    double rho;                     // probability that an extant tip is sampled
+
+    // Output
+    std::string treefile;
+    std::string eventfile;
+    std::string archivefile;
+    std::string fossiltreefile;     // "none": no fossil sampling
+    std::string fossileventfile;    // "none": no shifts on the fossil trees
+    std::string extanttreefile;     // "none": no reconstructed trees
+    std::string extanteventfile;    // "none": no shifts on the reconstructed trees
+    OutputFormat outputFormat;
+    OutputCompression treeCompression;
+    OutputCompression eventCompression;
+    OutputCompression fossilTreeCompression;
+    OutputCompression fossilEventCompression;
+    OutputCompression extantTreeCompression;
+    OutputCompression extantEventCompression;
+    bool streamOutput;
+    int outputFlushFreq;
+    int outputPrecision;
+    std::string metricsfile;        // "none": no run metrics
+    double metricsInterval;         // seconds; 0: only at the end
+    
+    // Checkpoint and resume (see Checkpoint)
+    std::string checkpointfile;     // "none": no checkpoints
+    int checkpointFreq;             // trees between checkpoints
+    bool resume;
+
+    SimulationConfig();
+
+    // Exits with an error message if a setting is invalid
+    explicit SimulationConfig(const Settings& settings);
+
+    // True if the tree or the event file is written to stdout
+    bool writesToStdout() const;
+    
+    bool writesCheckpoints() const;
+    bool samplesFossils() const;
+    bool remapsFossilEvents() const;
+    bool samplesExtant() const;
+    bool remapsExtantEvents() const;
+    
+    // Sims getFirstSim() to getEndSim() - 1 (from 0) are this shard's
+    //   (or the replayed sim)
+    int getFirstSim() const;
+    int getEndSim() const;
+};
+
+
+// Inserts tag before the file extension (and before .gz)
+std::string taggedFileName(const std::string& path, const std::string& tag);
+
+
+#endif /* defined(__simBAMM__SimulationConfig__) */
@@ -0,0 +1,305 @@
+//
+//  TreeArchive.cpp
+//  simBAMM
+//
+
+#include "TreeArchive.h"
+#include "SimTree.h"
+#include "BranchEvent.h"
+#include "Log.h"
+
+#include <cstring>
+#include <fstream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+TreeArchiveWriter::TreeArchiveWriter() :
+    _sink{},
+    _offsets{},
+    _flags{}
+{
+}
+
+
+bool TreeArchiveWriter::open(const std::string& path)
+{
+    if (path == "-"){
+        log(Error) << "The tree archive cannot be written to standard output.\n";
+        return false;
+    }
+    if (!_sink.open(path)){
+        return false;
+    }
+
+    _offsets.clear();
+    _sink.write(ArchiveMagic, sizeof(ArchiveMagic));
+    return true;
+}
+
+
+// The records are walked from their headers: a record holds 8 bytes per
+//   node for brlen, 9 for parent, regime and flags, and its events
+
+bool TreeArchiveWriter::resume(const std::string& path, uint64_t size)
+{
+    std::ifstream in(path.c_str(), std::ios::binary);
+    char magic[sizeof(ArchiveMagic)];
+    if (!in.read(magic, sizeof(magic)) ||
+            std::memcmp(magic, ArchiveMagic, sizeof(ArchiveMagic)) != 0){
+        log(Error) << "<<" << path << ">> is not a tree archive.\n";
+        return false;
+    }
+
+    _offsets.clear();
+    uint64_t offset = sizeof(ArchiveMagic);
+    while (offset < size){
+        ArchiveTreeHeader header;
+        in.seekg((std::streamoff)offset);
+        if (!in.read((char*)&header, sizeof(header))){
+            break;
+        }
+        _offsets.push_back(offset);
+        offset += sizeof(header) + header.numberOfNodes * (uint64_t)(sizeof(double) + 9) +
+            header.numberOfEvents * (uint64_t)sizeof(ArchiveEvent);
+        offset = (offset + 7) / 8 * 8;
+    }
+    if (offset != size){
+        log(Error) << "Tree archive <<" << path << ">> does not match the checkpoint.\n";
+        return false;
+    }
+    in.close();
+
+    return _sink.resume(path, size);
+}
+
+
+void TreeArchiveWriter::pad()
+{
+    static const char zeros[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    std::size_t n = (std::size_t)(_sink.getBytesWritten() % 8);
+    if (n != 0){
+        _sink.write(zeros, 8 - n);
+    }
+}
+
+
+void TreeArchiveWriter::writeTree(SimTree* tree)
+{
+    TreeStore* nodes = tree->getTreeStore();
+    uint32_t numberOfNodes = (uint32_t)nodes->size();
+    uint32_t numberOfEvents = (uint32_t)tree->getNumberOfShifts() + 1;
+
+    _offsets.push_back(_sink.getBytesWritten());
+
+    ArchiveTreeHeader header = {numberOfNodes, numberOfEvents, tree->getRoot(), 0};
+    _sink.write((const char*)&header, sizeof(header));
+    _sink.write((const char*)nodes->getBrlenArray(), numberOfNodes * sizeof(double));
+
+    for (uint32_t i = 0; i < numberOfEvents; i++){
+        BranchEvent* be = i == 0 ? tree->getRootEvent() : tree->getShiftEvent(i - 1);
+        ArchiveEvent event = {be->getEventNode(), 0, be->getEventTime(),
+            be->getLambdaInit(), be->getLambdaShift(), be->getMuInit()};
+        _sink.write((const char*)&event, sizeof(event));
+    }
+
+    _sink.write((const char*)nodes->getParentArray(), numberOfNodes * sizeof(NodeIndex));
+    _sink.write((const char*)nodes->getRegimeArray(), numberOfNodes * sizeof(uint32_t));
+
+    _flags.resize(numberOfNodes);
+    for (NodeIndex x = 0; x < numberOfNodes; x++){
+        NodeIndex parent = nodes->getParent(x);
+        _flags[x] = (uint8_t)((nodes->getIsTip(x) ? TipFlag : 0) |
+                              (nodes->getIsExtant(x) ? ExtantFlag : 0));
+        if (parent != NoNode && nodes->getLfDesc(parent) == x){
+            _flags[x] |= ArchiveLeftChild;
+        }
+    }
+    _sink.write((const char*)_flags.data(), _flags.size());
+    pad();
+}
+
+
+void TreeArchiveWriter::close()
+{
+    if (!_sink.isOpen()){
+        return;
+    }
+
+    ArchiveFooter footer;
+    footer.numberOfTrees = _offsets.size();
+    footer.indexOffset = _sink.getBytesWritten();
+    std::memcpy(footer.magic, ArchiveIndexMagic, sizeof(footer.magic));
+
+    _sink.write((const char*)_offsets.data(), _offsets.size() * sizeof(uint64_t));
+    _sink.write((const char*)&footer, sizeof(footer));
+    _sink.close();
+}
+
+
+void TreeArchiveWriter::flush()
+{
+    _sink.flush();
+}
+
+
+void TreeArchiveWriter::checkpoint()
+{
+    _sink.checkpoint();
+}
+
+
+TreeArchiveReader::TreeArchiveReader() :
+    _data{nullptr},
+    _size{0},
+    _offsets{nullptr},
+    _numberOfTrees{0},
+    _fallback{}
+{
+}
+
+
+TreeArchiveReader::~TreeArchiveReader()
+{
+    close();
+}
+
+
+bool TreeArchiveReader::mapFile(const std::string& path)
+{
+#ifndef _WIN32
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0){
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0){
+        ::close(fd);
+        return false;
+    }
+    void* data = mmap(nullptr, (std::size_t)info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED){
+        return false;
+    }
+    _data = (const char*)data;
+    _size = (std::size_t)info.st_size;
+#else
+    std::ifstream in(path.c_str(), std::ios::binary);
+    if (!in){
+        return false;
+    }
+    _fallback.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    _data = _fallback.data();
+    _size = _fallback.size();
+#endif
+    return true;
+}
+
+
+bool TreeArchiveReader::open(const std::string& path)
+{
+    close();
+
+    if (!mapFile(path)){
+        log(Error) << "Cannot read tree archive <<" << path << ">>.\n";
+        return false;
+    }
+
+    ArchiveFooter footer;
+    bool isValid = _size >= sizeof(ArchiveMagic) + sizeof(footer) &&
+        std::memcmp(_data, ArchiveMagic, sizeof(ArchiveMagic)) == 0;
+    if (isValid){
+        std::memcpy(&footer, _data + _size - sizeof(footer), sizeof(footer));
+        isValid = std::memcmp(footer.magic, ArchiveIndexMagic, sizeof(footer.magic)) == 0 &&
+            footer.indexOffset + footer.numberOfTrees * sizeof(uint64_t) + sizeof(footer) == _size;
+    }
+    if (!isValid){
+        log(Error) << "<<" << path << ">> is not a complete tree archive.\n";
+        close();
+        return false;
+    }
+
+    _offsets = (const uint64_t*)(_data + footer.indexOffset);
+    _numberOfTrees = footer.numberOfTrees;
+    return true;
+}
+
+
+void TreeArchiveReader::close()
+{
+#ifndef _WIN32
+    if (_data != nullptr){
+        munmap((void*)_data, _size);
+    }
+#endif
+    _fallback.clear();
+    _data = nullptr;
+    _size = 0;
+    _offsets = nullptr;
+    _numberOfTrees = 0;
+}
+
+
+ArchiveTreeView TreeArchiveReader::getTree(uint64_t i) const
+{
+    const char* p = _data + _offsets[i];
+
+    ArchiveTreeView view;
+    std::memcpy(&view.header, p, sizeof(view.header));
+    p += sizeof(view.header);
+
+    uint32_t n = view.header.numberOfNodes;
+    view.brlen = (const double*)p;
+    p += n * sizeof(double);
+    view.events = (const ArchiveEvent*)p;
+    p += view.header.numberOfEvents * sizeof(ArchiveEvent);
+    view.parent = (const uint32_t*)p;
+    p += n * sizeof(uint32_t);
+    view.regime = (const uint32_t*)p;
+    p += n * sizeof(uint32_t);
+    view.flags = (const uint8_t*)p;
+
+    return view;
+}
+
+
+// Parents always precede their children in the node arrays, so the
+//   node times can be rebuilt in one forward pass
+
+void TreeArchiveReader::readTree(uint64_t i, TreeStore& nodes,
+                                 std::vector<BranchEvent>& events) const
+{
+    ArchiveTreeView view = getTree(i);
+
+    nodes.clear();
+    nodes.reserve((int)view.header.numberOfNodes);
+    for (NodeIndex x = 0; x < view.header.numberOfNodes; x++){
+        NodeIndex parent = view.parent[x];
+        double time = parent == NoNode ? 0.0 : nodes.getTime(parent) + view.brlen[x];
+        nodes.addNode(parent, time, view.regime[x]);
+        nodes.setBrlen(x, view.brlen[x]);
+        nodes.setStatus(x, (view.flags[x] & TipFlag) != 0, (view.flags[x] & ExtantFlag) != 0);
+
+        if (parent != NoNode){
+            if (view.flags[x] & ArchiveLeftChild){
+                nodes.setLfDesc(parent, x);
+            }else{
+                nodes.setRtDesc(parent, x);
+            }
+        }
+    }
+
+    nodes.computeSpanningTips();
+
+    events.clear();
+    for (uint32_t k = 0; k < view.header.numberOfEvents; k++){
+        const ArchiveEvent& e = view.events[k];
+        events.push_back(BranchEvent(e.node, e.time, e.lambdaInit, e.lambdaShift, e.muInit));
+    }
+}
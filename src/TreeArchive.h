@@ -0,0 +1,162 @@
+//
+//  TreeArchive.h
+//  simBAMM
+//
+
+#ifndef __simBAMM__TreeArchive__
+#define __simBAMM__TreeArchive__
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "TreeStore.h"
+#include "OutputSink.h"
+
+class BranchEvent;
+class SimTree;
+
+
+// Binary tree archive: every simulated tree with its events, stored so
+//   that any one of them can be read without touching the others.
+//
+//   "SIMTREEA"                          8-byte file magic
+//   one record per tree, in sim order, each 8-byte aligned:
+//       ArchiveTreeHeader
+//       double       brlen[nodes]
+//       ArchiveEvent events[events]     root event first
+//       uint32       parent[nodes]
+//       uint32       regime[nodes]
+//       uint8        flags[nodes]       NodeFlags | ArchiveLeftChild
+//       zero padding to 8 bytes
+//   uint64 offset[trees]                file offset of each record
+//   ArchiveFooter
+//
+// Node arrays are in TreeStore order, so node i is tip A<i>/D<i>.
+// Numbers are stored in the byte order of the machine that wrote them.
+
+const char ArchiveMagic[8] = {'S', 'I', 'M', 'T', 'R', 'E', 'E', 'A'};
+const char ArchiveIndexMagic[8] = {'S', 'I', 'M', 'T', 'R', 'E', 'E', 'I'};
+
+// Set in the flags of a node that is the left child of its parent
+const uint8_t ArchiveLeftChild = 4;
+
+struct ArchiveTreeHeader {
+    uint32_t numberOfNodes;
+    uint32_t numberOfEvents;
+    uint32_t root;
+    uint32_t reserved;
+};
+
+struct ArchiveEvent {
+    uint32_t node;
+    uint32_t reserved;
+    double time;
+    double lambdaInit;
+    double lambdaShift;
+    double muInit;
+};
+
+struct ArchiveFooter {
+    uint64_t numberOfTrees;
+    uint64_t indexOffset;
+    char magic[8];
+};
+
+
+// Pointers into a mapped archive for one tree
+struct ArchiveTreeView {
+    ArchiveTreeHeader header;
+    const double* brlen;
+    const ArchiveEvent* events;
+    const uint32_t* parent;
+    const uint32_t* regime;
+    const uint8_t* flags;
+};
+
+
+class TreeArchiveWriter
+{
+
+private:
+
+    OutputSink _sink;
+    std::vector<uint64_t> _offsets;
+    std::vector<uint8_t> _flags;
+
+    void pad();
+
+public:
+
+    TreeArchiveWriter();
+
+    bool open(const std::string& path);
+    
+    // Reopens an archive at the end of the tree record that ends at size
+    //   (see Checkpoint), rebuilding the index of the records before it
+    bool resume(const std::string& path, uint64_t size);
+    
+    void writeTree(SimTree* tree);
+
+    // Writes the index and footer; the archive is unreadable without them
+    void close();
+
+    void flush();
+    void checkpoint();
+    uint64_t getNumberOfTrees() const;
+    uint64_t getBytesWritten() const;
+};
+
+
+class TreeArchiveReader
+{
+
+private:
+
+    const char* _data;
+    std::size_t _size;
+    const uint64_t* _offsets;
+    uint64_t _numberOfTrees;
+
+    std::vector<char> _fallback;    // file contents where mmap is unavailable
+
+    bool mapFile(const std::string& path);
+
+public:
+
+    TreeArchiveReader();
+    TreeArchiveReader(const TreeArchiveReader&) = delete;
+    TreeArchiveReader& operator=(const TreeArchiveReader&) = delete;
+    ~TreeArchiveReader();
+
+    bool open(const std::string& path);
+    void close();
+
+    uint64_t getNumberOfTrees() const;
+
+    // Tree i (0-based) in O(1); the view is valid until close()
+    ArchiveTreeView getTree(uint64_t i) const;
+
+    // Rebuilds tree i as a TreeStore and its events (root event first)
+    void readTree(uint64_t i, TreeStore& nodes, std::vector<BranchEvent>& events) const;
+};
+
+
+inline uint64_t TreeArchiveWriter::getNumberOfTrees() const
+{
+    return _offsets.size();
+}
+
+inline uint64_t TreeArchiveWriter::getBytesWritten() const
+{
+    return _sink.getBytesWritten();
+}
+
+inline uint64_t TreeArchiveReader::getNumberOfTrees() const
+{
+    return _numberOfTrees;
+}
+
+
+#endif /* defined(__simBAMM__TreeArchive__) */
@@ -0,0 +1,86 @@
+//
+//  TreeStore.cpp
+//  simBAMM
+//
+
+#include "TreeStore.h"
+
+
+TreeStore::TreeStore() :
+    _parent{},
+    _leftChild{},
+    _rightChild{},
+    _time{},
+    _brlen{},
+    _regime{},
+    _flags{},
+    _leftmostTip{},
+    _rightmostTip{}
+{
+}
+
+
+// Adds a node with no children and returns its index.
+// The branch length is the time elapsed since the parent.
+
+NodeIndex TreeStore::addNode(NodeIndex parent, double time, uint32_t regime)
+{
+    NodeIndex x = (NodeIndex)_parent.size();
+    
+    _parent.push_back(parent);
+    _leftChild.push_back(NoNode);
+    _rightChild.push_back(NoNode);
+    _time.push_back(time);
+    _brlen.push_back(parent == NoNode ? 0.0 : time - _time[parent]);
+    _regime.push_back(regime);
+    _flags.push_back(0);
+    
+    return x;
+}
+
+
+// The arrays keep their capacity for the next tree
+
+void TreeStore::clear()
+{
+    _parent.clear();
+    _leftChild.clear();
+    _rightChild.clear();
+    _time.clear();
+    _brlen.clear();
+    _regime.clear();
+    _flags.clear();
+    _leftmostTip.clear();
+    _rightmostTip.clear();
+}
+
+
+void TreeStore::reserve(int n)
+{
+    _parent.reserve(n);
+    _leftChild.reserve(n);
+    _rightChild.reserve(n);
+    _time.reserve(n);
+    _brlen.reserve(n);
+    _regime.reserve(n);
+    _flags.reserve(n);
+}
+
+
+// Children come after their parent, so a backward pass is post-order
+
+void TreeStore::computeSpanningTips()
+{
+    int n = size();
+    _leftmostTip.resize(n);
+    _rightmostTip.resize(n);
+    for (int x = n - 1; x >= 0; x--){
+        if (_leftChild[x] == NoNode){
+            _leftmostTip[x] = x;
+            _rightmostTip[x] = x;
+        }else{
+            _leftmostTip[x] = _leftmostTip[_leftChild[x]];
+            _rightmostTip[x] = _rightmostTip[_rightChild[x]];
+        }
+    }
+}
@@ -0,0 +1,196 @@
+//
+//  TreeStore.h
+//  simBAMM
+//
+
+#ifndef __simBAMM__TreeStore__
+#define __simBAMM__TreeStore__
+
+#include <cstdint>
+#include <vector>
+
+
+// Nodes are referred to by their position in the TreeStore
+typedef uint32_t NodeIndex;
+
+const NodeIndex NoNode = 0xFFFFFFFF;
+
+
+// Status bits of a node
+enum NodeFlags {
+    TipFlag    = 1,
+    ExtantFlag = 2
+};
+
+
+// Nodes of a simulated tree, stored as parallel arrays indexed by NodeIndex.
+// The regime of a node is the index of the event whose rates apply to the
+//   branch leading to it (0 for the root event).
+// The simulation creates each node before the nodes of its subtree, right
+//   subtree first, so the arrays are in depth-first (preorder) order and
+//   every subtree occupies a contiguous range.
+//
+// The tips that span each node, as the event files name a node by, are
+//   only known once the tree is complete: computeSpanningTips finds them
+//   for all the nodes in one pass.
+
+class TreeStore
+{
+
+private:
+
+    std::vector<NodeIndex> _parent;
+    std::vector<NodeIndex> _leftChild;
+    std::vector<NodeIndex> _rightChild;
+    std::vector<double>    _time;
+    std::vector<double>    _brlen;
+    std::vector<uint32_t>  _regime;
+    std::vector<uint8_t>   _flags;
+    
+    // Set by computeSpanningTips
+    std::vector<NodeIndex> _leftmostTip;
+    std::vector<NodeIndex> _rightmostTip;
+
+public:
+
+    // Memory used by the arrays for one node
+    static const int BytesPerNode = 5 * sizeof(NodeIndex) + 2 * sizeof(double)
+                                    + sizeof(uint32_t) + sizeof(uint8_t);
+
+    TreeStore();
+
+    NodeIndex addNode(NodeIndex parent, double time, uint32_t regime);
+    void clear();
+    void reserve(int n);
+    int size() const;
+
+    NodeIndex getParent(NodeIndex x) const;
+
+    NodeIndex getLfDesc(NodeIndex x) const;
+    void setLfDesc(NodeIndex x, NodeIndex y);
+
+    NodeIndex getRtDesc(NodeIndex x) const;
+    void setRtDesc(NodeIndex x, NodeIndex y);
+
+    double getTime(NodeIndex x) const;
+
+    double getBrlen(NodeIndex x) const;
+    void setBrlen(NodeIndex x, double y);
+
+    uint32_t getRegime(NodeIndex x) const;
+    void setRegime(NodeIndex x, uint32_t y);
+
+    bool getIsTip(NodeIndex x) const;
+    bool getIsExtant(NodeIndex x) const;
+    void setStatus(NodeIndex x, bool isTip, bool isExtant);
+    
+    // Tips reached from x by always following the right (left) child;
+    //   computeSpanningTips must have been called since the tree changed
+    void computeSpanningTips();
+    NodeIndex getRightmostTip(NodeIndex x) const;
+    NodeIndex getLeftmostTip(NodeIndex x) const;
+    
+    // Contiguous arrays of size() elements, for bulk output
+    const NodeIndex* getParentArray() const;
+    const double* getBrlenArray() const;
+    const uint32_t* getRegimeArray() const;
+};
+
+
+inline int TreeStore::size() const
+{
+    return (int)_parent.size();
+}
+
+inline NodeIndex TreeStore::getParent(NodeIndex x) const
+{
+    return _parent[x];
+}
+
+inline NodeIndex TreeStore::getLfDesc(NodeIndex x) const
+{
+    return _leftChild[x];
+}
+
+inline void TreeStore::setLfDesc(NodeIndex x, NodeIndex y)
+{
+    _leftChild[x] = y;
+}
+
+inline NodeIndex TreeStore::getRtDesc(NodeIndex x) const
+{
+    return _rightChild[x];
+}
+
+inline void TreeStore::setRtDesc(NodeIndex x, NodeIndex y)
+{
+    _rightChild[x] = y;
+}
+
+inline double TreeStore::getTime(NodeIndex x) const
+{
+    return _time[x];
+}
+
+inline double TreeStore::getBrlen(NodeIndex x) const
+{
+    return _brlen[x];
+}
+
+inline void TreeStore::setBrlen(NodeIndex x, double y)
+{
+    _brlen[x] = y;
+}
+
+inline uint32_t TreeStore::getRegime(NodeIndex x) const
+{
+    return _regime[x];
+}
+
+inline void TreeStore::setRegime(NodeIndex x, uint32_t y)
+{
+    _regime[x] = y;
+}
+
+inline bool TreeStore::getIsTip(NodeIndex x) const
+{
+    return (_flags[x] & TipFlag) != 0;
+}
+
+inline bool TreeStore::getIsExtant(NodeIndex x) const
+{
+    return (_flags[x] & ExtantFlag) != 0;
+}
+
+inline void TreeStore::setStatus(NodeIndex x, bool isTip, bool isExtant)
+{
+    _flags[x] = (uint8_t)((isTip ? TipFlag : 0) | (isExtant ? ExtantFlag : 0));
+}
+
+inline NodeIndex TreeStore::getRightmostTip(NodeIndex x) const
+{
+    return _rightmostTip[x];
+}
+
+inline NodeIndex TreeStore::getLeftmostTip(NodeIndex x) const
+{
+    return _leftmostTip[x];
+}
+
+inline const NodeIndex* TreeStore::getParentArray() const
+{
+    return _parent.data();
+}
+
+inline const double* TreeStore::getBrlenArray() const
+{
+    return _brlen.data();
+}
+
+inline const uint32_t* TreeStore::getRegimeArray() const
+{
+    return _regime.data();
+}
+
+
+#endif /* defined(__simBAMM__TreeStore__) */
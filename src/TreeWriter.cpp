@@ -0,0 +1,243 @@
+//
+//  TreeWriter.cpp
+//  simBAMM
+//
+
+#include "TreeWriter.h"
+#include "SimTree.h"
+#include "BranchEvent.h"
+#include "SampledTree.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+
+TreeWriter::TreeWriter(int precision) :
+    _buffer(1 << 16),
+    _size{0},
+    _precision{precision},
+    _stack{}
+{
+}
+
+
+// Returns room for n more bytes at the end of the buffer; the buffer
+//   only ever grows, so steady-state writing does not allocate
+
+char* TreeWriter::reserve(std::size_t n)
+{
+    if (_size + n > _buffer.size()){
+        std::size_t capacity = _buffer.size();
+        while (_size + n > capacity){
+            capacity *= 2;
+        }
+        _buffer.resize(capacity);
+    }
+    return _buffer.data() + _size;
+}
+
+
+void TreeWriter::append(const char* s, std::size_t n)
+{
+    std::memcpy(reserve(n), s, n);
+    _size += n;
+}
+
+
+void TreeWriter::append(const std::string& s)
+{
+    append(s.data(), s.size());
+}
+
+
+void TreeWriter::append(char c)
+{
+    *reserve(1) = c;
+    _size++;
+}
+
+
+void TreeWriter::appendInt(long x)
+{
+    char digits[24];
+    int n = 0;
+    unsigned long u = x < 0 ? 0UL - (unsigned long)x : (unsigned long)x;
+    do {
+        digits[n++] = (char)('0' + u % 10);
+        u /= 10;
+    } while (u != 0);
+    
+    char* out = reserve(n + 1);
+    if (x < 0){
+        *out++ = '-';
+        _size++;
+    }
+    for (int i = n - 1; i >= 0; i--){
+        *out++ = digits[i];
+    }
+    _size += n;
+}
+
+
+// With precision 0, 15 significant digits are tried first (every
+//   decimal of up to 15 digits survives the round trip through a double,
+//   and %g drops the trailing zeros), then 16 and 17, which always works
+
+void TreeWriter::appendDouble(double x)
+{
+    const std::size_t maxLength = 32;
+    char* out = reserve(maxLength);
+    int n = 0;
+    
+    if (_precision > 0){
+        n = std::snprintf(out, maxLength, "%.*g", _precision, x);
+    }else{
+        for (int digits = 15; digits <= 17; digits++){
+            n = std::snprintf(out, maxLength, "%.*g", digits, x);
+            if (std::strtod(out, nullptr) == x){
+                break;
+            }
+        }
+    }
+    _size += n;
+}
+
+
+// Names are made from the node as it is written, rather than stored: A#
+//   for an extant tip and D# for an extinct one, # being its index
+
+void TreeWriter::appendTipName(const TreeStore* nodes, NodeIndex x)
+{
+    append(nodes->getIsExtant(x) ? 'A' : 'D');
+    appendInt((long)x);
+}
+
+
+// Tips that were tips of the simulated tree keep their names
+
+void TreeWriter::appendTipName(const SampledTree* tree, NodeIndex x)
+{
+    if (tree->getIsFossilTip(x)){
+        append("NN", 2);
+        appendInt((long)tree->getTipNumber(x));
+    }else{
+        appendTipName(tree->getSimulatedTree(), tree->getSource(x));
+    }
+}
+
+
+void TreeWriter::appendTipName(const TreeStore* nodes, NodeIndex x, const SampledTree* sampled)
+{
+    if (sampled != nullptr){
+        appendTipName(sampled, x);
+    }else{
+        appendTipName(nodes, x);
+    }
+}
+
+
+void TreeWriter::writeNewick(SimTree* tree)
+{
+    writeNewick(tree->getTreeStore(), tree->getRoot(), nullptr);
+}
+
+
+void TreeWriter::writeNewick(const TreeStore* nodes, NodeIndex root)
+{
+    writeNewick(nodes, root, nullptr);
+}
+
+
+void TreeWriter::writeNewick(const SampledTree* tree)
+{
+    if (tree->getRoot() == NoNode){
+        append(";\n", 2);
+        return;
+    }
+    writeNewick(tree->getTreeStore(), tree->getRoot(), tree);
+}
+
+
+// Iterative preorder walk; the left child is written first, as in
+//   the original recursive writer
+
+void TreeWriter::writeNewick(const TreeStore* nodes, NodeIndex root, const SampledTree* sampled)
+{
+    _stack.clear();
+    _stack.push_back({root, OpenNode});
+    
+    while (!_stack.empty()){
+        NewickStep step = _stack.back();
+        _stack.pop_back();
+        NodeIndex x = step.node;
+        
+        if (step.token == Separator){
+            append(',');
+        }else if (step.token == CloseNode){
+            append("):", 2);
+            appendDouble(nodes->getBrlen(x));
+        }else if (nodes->getLfDesc(x) == NoNode && nodes->getRtDesc(x) == NoNode){
+            appendTipName(nodes, x, sampled);
+            append(':');
+            appendDouble(nodes->getBrlen(x));
+        }else{
+            append('(');
+            _stack.push_back({x, CloseNode});
+            _stack.push_back({nodes->getRtDesc(x), OpenNode});
+            _stack.push_back({x, Separator});
+            _stack.push_back({nodes->getLfDesc(x), OpenNode});
+        }
+    }
+    
+    append(";\n", 2);
+}
+
+
+void TreeWriter::writeEventData(int index, SimTree* tree)
+{
+    TreeStore* nodes = tree->getTreeStore();
+    
+    writeEventRow(index, nodes, tree->getRootEvent());
+    for (int i = 0; i < tree->getNumberOfShifts(); i++){
+        writeEventRow(index, nodes, tree->getShiftEvent(i));
+    }
+}
+
+
+void TreeWriter::writeEventData(int index, const SampledTree* tree)
+{
+    for (int k = 0; k < tree->getNumberOfEvents(); k++){
+        BranchEvent event = tree->getEvent(k);
+        writeEventRow(index, tree->getTreeStore(), &event, tree);
+    }
+}
+
+
+void TreeWriter::writeEventRow(int index, const TreeStore* nodes, BranchEvent* be)
+{
+    writeEventRow(index, nodes, be, nullptr);
+}
+
+
+// The leftchild column holds the rightmost tip below the event node and
+//   rightchild the leftmost, as simtree has always written them
+
+void TreeWriter::writeEventRow(int index, const TreeStore* nodes, BranchEvent* be,
+                               const SampledTree* sampled)
+{
+    appendInt(index);
+    append(',');
+    appendTipName(nodes, nodes->getRightmostTip(be->getEventNode()), sampled);
+    append(',');
+    appendTipName(nodes, nodes->getLeftmostTip(be->getEventNode()), sampled);
+    append(',');
+    appendDouble(be->getEventTime());
+    append(',');
+    appendDouble(be->getLambdaInit());
+    append(',');
+    appendDouble(be->getLambdaShift());
+    append(',');
+    appendDouble(be->getMuInit());
+    append('\n');
+}
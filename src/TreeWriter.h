@@ -0,0 +1,119 @@
+//
+//  TreeWriter.h
+//  simBAMM
+//
+
+#ifndef __simBAMM__TreeWriter__
+#define __simBAMM__TreeWriter__
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "TreeStore.h"
+
+class BranchEvent;
+class SampledTree;
+class SimTree;
+
+
+// Serializes trees to Newick and their events to the event-file CSV
+//   format, straight into a byte buffer that is reused from tree to tree.
+// Tips are labelled A# (extant) or D# (extinct), # being the node index.
+// Branch lengths and rates are written with `precision` significant
+//   digits (printf %g, as iostreams do by default with precision 6);
+//   a precision of 0 writes the shortest text that reads back as the
+//   same double.
+
+class TreeWriter
+{
+
+private:
+
+    // Entries of the explicit traversal stack used by writeNewick
+    enum NewickToken {
+        OpenNode,
+        Separator,
+        CloseNode
+    };
+
+    struct NewickStep {
+        NodeIndex node;
+        NewickToken token;
+    };
+
+    std::vector<char> _buffer;
+    std::size_t _size;
+    int _precision;
+
+    std::vector<NewickStep> _stack;
+
+    char* reserve(std::size_t n);
+    void append(const char* s, std::size_t n);
+    void append(const std::string& s);
+    void append(char c);
+    void appendInt(long x);
+    void appendDouble(double x);
+    void appendTipName(const TreeStore* nodes, NodeIndex x);
+    void appendTipName(const SampledTree* tree, NodeIndex x);
+    
+    // Tips are named from sampled if it is not nullptr
+    void appendTipName(const TreeStore* nodes, NodeIndex x, const SampledTree* sampled);
+    void writeNewick(const TreeStore* nodes, NodeIndex root, const SampledTree* sampled);
+    void writeEventRow(int index, const TreeStore* nodes, BranchEvent* be,
+                       const SampledTree* sampled);
+
+public:
+
+    explicit TreeWriter(int precision = 6);
+
+    // Appends the tree as one Newick line, terminated by ";\n"
+    void writeNewick(SimTree* tree);
+    void writeNewick(const TreeStore* nodes, NodeIndex root);
+    
+    // An empty sampled tree is written as ";\n"
+    void writeNewick(const SampledTree* tree);
+
+    // Appends one CSV row per event (root event first); index is the
+    //   value of the sim column
+    void writeEventData(int index, SimTree* tree);
+    void writeEventData(int index, const SampledTree* tree);
+    void writeEventRow(int index, const TreeStore* nodes, BranchEvent* be);
+
+    void clear();
+    const char* data() const;
+    std::size_t size() const;
+
+    int getPrecision() const;
+    void setPrecision(int precision);
+};
+
+
+inline void TreeWriter::clear()
+{
+    _size = 0;
+}
+
+inline const char* TreeWriter::data() const
+{
+    return _buffer.data();
+}
+
+inline std::size_t TreeWriter::size() const
+{
+    return _size;
+}
+
+inline int TreeWriter::getPrecision() const
+{
+    return _precision;
+}
+
+inline void TreeWriter::setPrecision(int precision)
+{
+    _precision = precision;
+}
+
+
+#endif /* defined(__simBAMM__TreeWriter__) */
@@ -11,6 +11,8 @@
 #include <vector>
 #include <sstream>
 #include <fstream>
+#include <cstdlib>
+#include <cstdint>
 
 #include "CommandLineProcessor.h"
 #include "Log.h"
@@ -18,6 +20,9 @@
 #include "MbRandom.h"
 #include "SimTree.h"
 #include "SimTreeEngine.h"
+#include "SimulationConfig.h"
+#include "ParameterSweep.h"
+#include "Checkpoint.h"
 
 long int getPrecisionTime();
 
@@ -29,28 +34,47 @@ int main(int argc, char * argv[])
     
     Settings mySettings(commandLine.controlFileName(), commandLine.parameters());
     
+    // Parsed and checked once; exits here if a setting is invalid
+    SimulationConfig config(mySettings);
+    
+    // --resume continues from the checkpoint, if there is one, with its seed
+    Checkpoint checkpoint;
+    bool isResuming = config.resume && checkpoint.read(config.checkpointfile);
+    if (isResuming){
+        checkpoint.checkCanResume(config);
+    }else if (config.resume){
+        std::cout << "No checkpoint <<" << config.checkpointfile << ">>; starting a new run.\n";
+    }
+    
     // Use high-precision chronos library for seed.
     // Requires C++11.
     
-    long int seed = mySettings.get<long int>("seed");
+    long int seed = isResuming ? checkpoint.seed : config.seed;
     
     if (seed == -1){
-        long int seed = getPrecisionTime();
+        seed = getPrecisionTime();
+        std::ostream& console = config.writesToStdout() ? std::cerr : std::cout;
+        console << "seed: " << seed << "\n";
     }
  
     
-    MbRandom myRNG;
-    myRNG.setSeed(seed);
+    MbRandom myRNG(config.rngEngine, seed);
     
-    // warmup
-    for (int i = 0; i < 5000; i++){
-        myRNG.uniformRv();
+    // warmup (the legacy generator only; Philox streams need none)
+    if (config.rngEngine == LcgEngine){
+        for (int i = 0; i < 5000; i++){
+            myRNG.uniformRv();
+        }
     }
  
     
-    std::cout << "Simulating....\n";
- 
-    SimTreeEngine simengine(&mySettings, &myRNG);
+    if (ParameterSweep::isRequested(mySettings)){
+        ParameterSweep sweep(mySettings);
+        sweep.writeConfigTable(mySettings.get("sweepConfigFile"));
+        SimTreeEngine simengine(sweep.getConfigs(), &myRNG);
+    }else{
+        SimTreeEngine simengine(&config, &myRNG, isResuming ? &checkpoint : nullptr);
+    }
     
     return 0;
     
@@ -58,17 +82,20 @@ int main(int argc, char * argv[])
     
 }
 
+// A seed from every bit of the clock, mixed (splitmix64 finalizer) so that
+//   runs started close together get unrelated seeds. Seeds are in
+//   1 to 2^31 - 2, the range the lcg engine accepts.
+
 long int getPrecisionTime()
 {
     auto now = std::chrono::high_resolution_clock::now();
     auto dur = now.time_since_epoch();
     
-    long int rmd = (long int)dur.count() %  1000000;
-
-    //typedef std::chrono::high_resolution_clock::period period_t;
-    //auto dur = now.time_since_epoch();
-    //std::cout << "High-res clock reports " << dur.count() << " ticks of 1/" << period_t::den << " seconds \n";
+    uint64_t z = (uint64_t)dur.count() + 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z = z ^ (z >> 31);
     
-    return rmd;
+    return (long int)(z % 2147483646ULL) + 1;
 }
 
@@ -0,0 +1,112 @@
+//
+//  simtree_archive.cpp
+//  simBAMM
+//
+//  Converts a binary tree archive (outputFormat = archive) back to the
+//  Newick tree file and event CSV file simtree writes as text.
+//
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "BranchEvent.h"
+#include "OutputSink.h"
+#include "TreeArchive.h"
+#include "TreeStore.h"
+#include "TreeWriter.h"
+
+
+void exitWithUsage()
+{
+    std::cerr << "Usage: simtree_archive <archive> <treefile> <eventfile> "
+                 "[--sim <i>] [--precision <digits>]\n"
+                 "Writes every tree (or only sim i, counting from 1) as text; "
+                 "a file name of - writes to standard output, "
+                 "names ending in .gz are gzipped.\n";
+    std::exit(1);
+}
+
+
+int main(int argc, char* argv[])
+{
+    if (argc < 4){
+        exitWithUsage();
+    }
+    
+    std::string archiveName(argv[1]);
+    std::string treeName(argv[2]);
+    std::string eventName(argv[3]);
+    
+    long only = 0;
+    int precision = 6;
+    for (int i = 4; i < argc; i += 2){
+        std::string argName(argv[i]);
+        if (i + 1 == argc){
+            exitWithUsage();
+        }
+        if (argName == "--sim"){
+            only = std::atol(argv[i + 1]);
+        }else if (argName == "--precision"){
+            precision = std::atoi(argv[i + 1]);
+        }else{
+            exitWithUsage();
+        }
+    }
+    
+    if (treeName == "-" && eventName == "-"){
+        std::cerr << "treefile and eventfile cannot both be written to stdout" << std::endl;
+        return 1;
+    }
+    
+    TreeArchiveReader archive;
+    if (!archive.open(archiveName)){
+        return 1;
+    }
+    
+    uint64_t first = 0;
+    uint64_t last = archive.getNumberOfTrees();
+    if (only != 0){
+        if (only < 1 || (uint64_t)only > archive.getNumberOfTrees()){
+            std::cerr << "The archive holds sims 1 to " << archive.getNumberOfTrees() << std::endl;
+            return 1;
+        }
+        first = (uint64_t)only - 1;
+        last = first + 1;
+    }
+    
+    OutputSink treeSink;
+    OutputSink eventSink;
+    OutputCompression treeCompression =
+        OutputSink::hasGzipExtension(treeName) ? GzipCompression : NoCompression;
+    OutputCompression eventCompression =
+        OutputSink::hasGzipExtension(eventName) ? GzipCompression : NoCompression;
+    if (!treeSink.open(treeName, treeCompression) || !eventSink.open(eventName, eventCompression)){
+        return 1;
+    }
+    eventSink.write("sim,leftchild,rightchild,abstime,lambdainit,lambdashift,muinit\n");
+    
+    TreeWriter writer(precision);
+    TreeStore nodes;
+    std::vector<BranchEvent> events;
+    
+    for (uint64_t i = first; i < last; i++){
+        archive.readTree(i, nodes, events);
+        
+        writer.clear();
+        writer.writeNewick(&nodes, archive.getTree(i).header.root);
+        treeSink.write(writer.data(), writer.size());
+        
+        writer.clear();
+        for (int k = 0; k < (int)events.size(); k++){
+            writer.writeEventRow((int)i + 1, &nodes, &events[k]);
+        }
+        eventSink.write(writer.data(), writer.size());
+    }
+    
+    treeSink.close();
+    eventSink.close();
+    
+    return 0;
+}
@@ -0,0 +1,198 @@
+//
+//  simtree_merge.cpp
+//  simBAMM
+//
+//  Joins the tree and event files of the shards of a run (shard = k/N)
+//  into the files one process would have written for the whole run.
+//
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#ifdef SIMTREE_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#include "OutputSink.h"
+#include "SimulationConfig.h"
+
+
+void exitWithUsage()
+{
+    std::cerr << "Usage: simtree_merge <treefile> <eventfile> <shards>\n"
+                 "Reads the files of shards 1 to <shards> (simtrees_s1.txt, "
+                 "events_s1.txt, ...) and writes them as <treefile> and <eventfile>, "
+                 "with the sims numbered over the whole run; "
+                 "names ending in .gz are read and written gzipped.\n";
+    std::exit(1);
+}
+
+
+// Reads a text file line by line, gunzipping it if its name ends in .gz
+
+class ShardFile
+{
+
+private:
+
+    std::ifstream _in;
+#ifdef SIMTREE_HAVE_ZLIB
+    gzFile _gz;
+#endif
+    bool _isGzip;
+
+public:
+
+    ShardFile() :
+        _in{},
+#ifdef SIMTREE_HAVE_ZLIB
+        _gz{nullptr},
+#endif
+        _isGzip{false}
+    {
+    }
+
+    ~ShardFile()
+    {
+#ifdef SIMTREE_HAVE_ZLIB
+        if (_gz != nullptr){
+            gzclose(_gz);
+        }
+#endif
+    }
+
+    bool open(const std::string& path)
+    {
+        _isGzip = OutputSink::hasGzipExtension(path);
+        if (!_isGzip){
+            _in.open(path.c_str(), std::ios::binary);
+            return (bool)_in;
+        }
+#ifdef SIMTREE_HAVE_ZLIB
+        _gz = gzopen(path.c_str(), "rb");
+        return _gz != nullptr;
+#else
+        std::cerr << "simtree_merge was built without zlib and cannot read " << path << std::endl;
+        return false;
+#endif
+    }
+
+    // The line without its newline; false at the end of the file
+    bool getline(std::string& line)
+    {
+        if (!_isGzip){
+            return (bool)std::getline(_in, line);
+        }
+        line.clear();
+#ifdef SIMTREE_HAVE_ZLIB
+        char chunk[1 << 16];
+        while (gzgets(_gz, chunk, sizeof(chunk)) != nullptr){
+            std::size_t n = std::strlen(chunk);
+            if (n > 0 && chunk[n - 1] == '\n'){
+                line.append(chunk, n - 1);
+                return true;
+            }
+            line.append(chunk, n);
+        }
+#endif
+        return !line.empty();
+    }
+};
+
+
+int main(int argc, char* argv[])
+{
+    if (argc != 4){
+        exitWithUsage();
+    }
+
+    std::string treeName(argv[1]);
+    std::string eventName(argv[2]);
+    int shards = std::atoi(argv[3]);
+    if (shards < 1){
+        exitWithUsage();
+    }
+
+    if (treeName == "-" && eventName == "-"){
+        std::cerr << "treefile and eventfile cannot both be written to stdout" << std::endl;
+        return 1;
+    }
+
+    OutputSink treeSink;
+    OutputSink eventSink;
+    OutputCompression treeCompression =
+        OutputSink::hasGzipExtension(treeName) ? GzipCompression : NoCompression;
+    OutputCompression eventCompression =
+        OutputSink::hasGzipExtension(eventName) ? GzipCompression : NoCompression;
+    if (!treeSink.open(treeName, treeCompression) || !eventSink.open(eventName, eventCompression)){
+        return 1;
+    }
+
+    std::string header = "sim,leftchild,rightchild,abstime,lambdainit,lambdashift,muinit";
+    eventSink.write(header + "\n");
+
+    // Each shard numbers its sims on its own or over the run; either way its
+    //   k-th distinct sim number is sim (trees before it) + k of the run
+    long numberOfTrees = 0;
+    std::string line;
+    for (int k = 1; k <= shards; k++){
+        std::string tag = "_s" + std::to_string(k);
+        std::string shardTreeName = taggedFileName(treeName, tag);
+        std::string shardEventName = taggedFileName(eventName, tag);
+
+        ShardFile trees;
+        ShardFile events;
+        if (!trees.open(shardTreeName) || !events.open(shardEventName)){
+            std::cerr << "Cannot read " << shardTreeName << " or " << shardEventName << std::endl;
+            return 1;
+        }
+
+        long shardTrees = 0;
+        while (trees.getline(line)){
+            if (line.empty()){
+                continue;
+            }
+            treeSink.write(line);
+            treeSink.write("\n", 1);
+            shardTrees++;
+        }
+
+        if (!events.getline(line) || line != header){
+            std::cerr << shardEventName << " is not a simtree event file" << std::endl;
+            return 1;
+        }
+
+        long shardSims = 0;
+        std::string lastSim;
+        while (events.getline(line)){
+            std::size_t comma = line.find(',');
+            if (comma == std::string::npos){
+                continue;
+            }
+            std::string sim = line.substr(0, comma);
+            if (sim != lastSim){
+                lastSim = sim;
+                shardSims++;
+            }
+            eventSink.write(std::to_string(numberOfTrees + shardSims));
+            eventSink.write(line.data() + comma, line.size() - comma);
+            eventSink.write("\n", 1);
+        }
+
+        if (shardSims != shardTrees){
+            std::cerr << shardTreeName << " holds " << shardTrees << " trees but "
+                      << shardEventName << " has events for " << shardSims << std::endl;
+            return 1;
+        }
+        numberOfTrees += shardTrees;
+    }
+
+    treeSink.close();
+    eventSink.close();
+
+    std::cerr << "merged " << numberOfTrees << " trees from " << shards << " shards" << std::endl;
+    return 0;
+}